@@ -0,0 +1,371 @@
+/**
+ *
+ * main.cpp gpu_culling
+ *
+ * Covers the following:
+ * - culling instances against the view frustum in a compute shader
+ * - compacting the visible instances into indirect draw commands on the device
+ * - drawing with an indirect count, the draw count is never read back by the host
+ * - fetching the instance transforms from a storage buffer via gl_InstanceIndex
+ * - recording a compute pass before the render pass in the same command buffer
+ */
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#define GLM_FORCE_RADIANS
+// the culling expects a [0, 1] depth range
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <ri/ApplicationInstance.h>
+#include <ri/Buffer.h>
+#include <ri/CommandBuffer.h>
+#include <ri/DescriptorPool.h>
+#include <ri/DescriptorSet.h>
+#include <ri/DeviceContext.h>
+#include <ri/GpuCulling.h>
+#include <ri/RenderPass.h>
+#include <ri/RenderPipeline.h>
+#include <ri/RenderTarget.h>
+#include <ri/ShaderModule.h>
+#include <ri/ShaderPipeline.h>
+#include <ri/Surface.h>
+#include <ri/ValidationReport.h>
+#include <ri/VertexDescription.h>
+
+const int kWidth  = 800;
+const int kHeight = 600;
+// instances on a grid, most of them are outside of the view
+const uint32_t kGridSize      = 64;
+const uint32_t kInstanceCount = kGridSize * kGridSize;
+const float    kGridSpacing   = 2.f;
+
+struct Vertex
+{
+    struct Pos
+    {
+        float x, y;
+    };
+    struct Color
+    {
+        float r, g, b;
+    };
+    Pos   pos;
+    Color color;
+};
+
+const std::vector<Vertex>   kVertices = {{{-0.5f, -0.5f}, {1.0f, 0.0f, 0.0f}},
+                                       {{0.5f, -0.5f}, {0.0f, 1.0f, 0.0f}},
+                                       {{0.5f, 0.5f}, {0.0f, 0.0f, 1.0f}},
+                                       {{-0.5f, 0.5f}, {1.0f, 1.0f, 1.0f}}};
+const std::vector<uint16_t> kIndices  = {0, 1, 2, 2, 3, 0};
+
+class DemoApplication
+{
+public:
+    DemoApplication()
+        : m_validation(nullptr)
+    {
+    }
+
+    void run()
+    {
+        initialize();
+        mainLoop();
+        cleanup();
+    }
+
+private:
+    void initWindow()
+    {
+        glfwInit();
+
+        glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+        glfwWindowHint(GLFW_RESIZABLE, true);
+
+        m_window = glfwCreateWindow(kWidth, kHeight, "GPU Culling", nullptr, nullptr);
+
+        glfwSetWindowUserPointer(m_window, this);
+        glfwSetWindowSizeCallback(m_window, DemoApplication::onWindowResized);
+    }
+
+    static void onWindowResized(GLFWwindow* window, int width, int height)
+    {
+        if (width < 32 || height < 32)
+            return;
+
+        DemoApplication* app = reinterpret_cast<DemoApplication*>(glfwGetWindowUserPointer(window));
+        app->resizeWindow();
+    }
+
+    void initialize()
+    {
+        initWindow();
+
+        m_instance.reset(new ri::ApplicationInstance("GPU Culling"));
+        m_validation.reset(new ri::ValidationReport(*m_instance, ri::ReportLevel::eWarning));
+
+        m_surface.reset(  //
+            new ri::Surface(*m_instance, ri::Sizei(kWidth, kHeight), m_window, ri::PresentMode::eMailbox));
+        m_surface->setTagName("MainWindowSurface");
+
+        // create the device context
+        {
+            const std::vector<ri::DeviceFeature> requiredFeatures = {
+                ri::DeviceFeature::eSwapchain, ri::DeviceFeature::eMultiDrawIndirect,
+                ri::DeviceFeature::eDrawIndirectCount};
+            const std::vector<ri::DeviceOperation> requiredOperations = {ri::DeviceOperation::eGraphics,
+                                                                         ri::DeviceOperation::eCompute};
+
+            // the culling depends on the view, the command buffers are recorded every frame
+            ri::DeviceContext::CommandPoolParam param = {ri::DeviceCommandHint::eTransient, true};
+
+            m_context.reset(new ri::DeviceContext(*m_instance));
+            m_context->initialize(*m_surface, requiredFeatures, requiredOperations, param);
+            m_context->setTagName("MainContext");
+        }
+
+        // create a shader pipeline and let it own the shader modules
+        {
+            const std::string shadersPath = "../gpu_culling/shaders/";
+            m_shaderPipeline.reset(new ri::ShaderPipeline());
+            m_shaderPipeline->addStage(
+                new ri::ShaderModule(*m_context, shadersPath + "shader.frag", ri::ShaderStage::eFragment));
+            m_shaderPipeline->addStage(
+                new ri::ShaderModule(*m_context, shadersPath + "shader.vert", ri::ShaderStage::eVertex));
+            m_shaderPipeline->setTagName("InstancedShaderPipeline");
+        }
+
+        // create the vertex and index buffers, written once so they're kept host visible
+        {
+            m_vertexBuffer.reset(
+                new ri::Buffer(*m_context, ri::BufferUsageFlags::eVertex, sizeof(kVertices[0]) * kVertices.size()));
+            m_vertexBuffer->setTagName("VertexBuffer");
+            m_vertexBuffer->update(kVertices.data());
+            m_indexBuffer.reset(
+                new ri::Buffer(*m_context, ri::BufferUsageFlags::eIndex, sizeof(kIndices[0]) * kIndices.size()));
+            m_indexBuffer->setTagName("IndexBuffer");
+            m_indexBuffer->update(kIndices.data());
+
+            ri::VertexBinding binding({{0, ri::AttributeFormat::eFloat2, offsetof(Vertex, pos)},
+                                       {1, ri::AttributeFormat::eFloat3, offsetof(Vertex, color)}});
+            binding.bindingIndex = 0;
+            binding.buffer       = m_vertexBuffer.get();
+            binding.offset       = 0;
+            binding.stride       = sizeof(Vertex);
+            m_vertexDescription.create(binding);
+            m_vertexDescription.setIndexBuffer(*m_indexBuffer, ri::IndexType::eInt16);
+            m_vertexDescription.setTagName("InputLayout");
+        }
+
+        // create the culling inputs, a single mesh drawn by all the instances
+        {
+            std::vector<ri::GpuCulling::Instance> instances(kInstanceCount);
+            std::vector<glm::mat4>                transforms(kInstanceCount);
+            const float                           offset = (kGridSize - 1) * kGridSpacing * 0.5f;
+            for (uint32_t i = 0; i < kInstanceCount; ++i)
+            {
+                const glm::vec3 position((i % kGridSize) * kGridSpacing - offset,
+                                         (i / kGridSize) * kGridSpacing - offset, 0.f);
+                transforms[i] = glm::translate(glm::mat4(1.f), position);
+
+                // bounds the quad's corners
+                auto& instance             = instances[i];
+                instance.boundingSphere[0] = 0.f;
+                instance.boundingSphere[1] = 0.f;
+                instance.boundingSphere[2] = 0.f;
+                instance.boundingSphere[3] = 0.71f;
+                instance.meshIndex         = 0;
+            }
+
+            m_instanceBuffer.reset(new ri::Buffer(*m_context, ri::BufferUsageFlags::eStorage,
+                                                  sizeof(ri::GpuCulling::Instance) * kInstanceCount));
+            m_instanceBuffer->setTagName("InstanceBuffer");
+            m_instanceBuffer->update(instances.data());
+            m_transformBuffer.reset(
+                new ri::Buffer(*m_context, ri::BufferUsageFlags::eStorage, sizeof(glm::mat4) * kInstanceCount));
+            m_transformBuffer->setTagName("TransformBuffer");
+            m_transformBuffer->update(transforms.data());
+
+            // the draw command template of the mesh, the culling sets the instance
+            VkDrawIndexedIndirectCommand mesh = {};
+            mesh.indexCount                   = kIndices.size();
+            mesh.instanceCount                = 1;
+            m_meshBuffer.reset(
+                new ri::Buffer(*m_context, ri::BufferUsageFlags::eStorage, sizeof(VkDrawIndexedIndirectCommand)));
+            m_meshBuffer->setTagName("MeshBuffer");
+            m_meshBuffer->writeCommands(&mesh, 1);
+
+            ri::ShaderModule cullingShader(*m_context, "../resources/shaders/culling.comp", ri::ShaderStage::eCompute);
+            m_culling.reset(new ri::GpuCulling(*m_context, cullingShader, kInstanceCount));
+            m_culling->setInputs(*m_instanceBuffer, *m_transformBuffer, *m_meshBuffer);
+        }
+
+        ri::DescriptorSetLayout descriptorLayout;
+        // create a descriptor pool, the vertex shader reads the transforms
+        {
+            m_descriptorPool.reset(new ri::DescriptorPool(*m_context, 1, ri::DescriptorType::eStorageBuffer, 1));
+            auto res = m_descriptorPool->createLayout(
+                ri::DescriptorLayoutParam({0, ri::ShaderStage::eVertex, ri::DescriptorType::eStorageBuffer}));
+            descriptorLayout = res.layout;
+
+            const ri::DescriptorSetParams params = {
+                {0, m_transformBuffer.get(), ri::DescriptorType::eStorageBuffer}};
+            m_descriptor = m_descriptorPool->create(res.index, params);
+        }
+
+        // create the render/graphics pipeline
+        {
+            ri::RenderPass::AttachmentParams passParams;
+            passParams.format    = m_surface->format();
+            ri::RenderPass* pass = new ri::RenderPass(*m_context, passParams);
+            pass->setTagName("SimplePass");
+
+            ri::RenderPipeline::CreateParams params;
+            // needed to change viewport for resizing
+            params.dynamicStates     = {ri::DynamicState::eViewport, ri::DynamicState::eScissor};
+            params.vertexDescription = &m_vertexDescription;
+            params.cullMode          = ri::CullMode::eNone;
+            params.descriptorLayouts.push_back(descriptorLayout);
+            // the view projection matrix
+            params.pushConstants.emplace_back(ri::ShaderStage::eVertex, 0, sizeof(glm::mat4));
+
+            m_renderPipeline.reset(
+                new ri::RenderPipeline(*m_context, pass, *m_shaderPipeline, params, ri::Sizei(kWidth, kHeight)));
+            m_renderPipeline->setTagName("InstancedPipeline");
+        }
+
+        std::cout << "instances: " << kInstanceCount << std::endl;
+    }
+
+    glm::mat4 viewProjection() const
+    {
+        static auto startTime = std::chrono::high_resolution_clock::now();
+
+        auto  currentTime = std::chrono::high_resolution_clock::now();
+        float time        = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
+
+        // orbits low above the grid, so the frustum only covers a part of it
+        const float     angle = time * glm::radians(20.0f);
+        const glm::vec3 eye(std::cos(angle) * 20.f, std::sin(angle) * 20.f, 4.f);
+        const glm::mat4 view = glm::lookAt(eye, glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+        glm::mat4       proj = glm::perspective(
+            glm::radians(45.0f), m_surface->size().width / (float)m_surface->size().height, 0.1f, 100.0f);
+        // flip Y
+        proj[1][1] *= -1;
+        return proj * view;
+    }
+
+    void dispatchCommands(const ri::RenderTarget& target, ri::CommandBuffer& commandBuffer)
+    {
+        const glm::mat4 viewProjection = this->viewProjection();
+
+        // writes the draw commands of the visible instances, must be recorded outside of the render pass
+        m_culling->cull(commandBuffer, &viewProjection[0][0], kInstanceCount);
+
+        m_renderPipeline->dynamicState().setViewport(commandBuffer, target.size());
+        m_renderPipeline->dynamicState().setScissor(commandBuffer, target.size());
+
+        m_renderPipeline->begin(commandBuffer, target);
+
+        m_vertexDescription.bind(commandBuffer);
+        m_descriptor.bind(commandBuffer, *m_renderPipeline);
+        m_renderPipeline->pushConstants(&viewProjection[0][0], ri::ShaderStage::eVertex, 0, sizeof(glm::mat4),
+                                        commandBuffer);
+        // a draw per visible instance, the count is read by the device
+        m_culling->draw(commandBuffer);
+
+        m_renderPipeline->end(commandBuffer);
+    }
+
+    void render()
+    {
+        // the culling buffers are shared by the frames
+        m_surface->waitIdle();
+        const uint32_t activeIndex = m_surface->acquire();
+
+        auto& commandBuffer = m_surface->commandBuffer(activeIndex);
+
+        // must update before binding the render pipeline
+        m_renderPipeline->defaultPass().setRenderArea(m_surface->size());
+
+        commandBuffer.begin(ri::RecordFlags::eResubmit);
+        dispatchCommands(m_surface->renderTarget(activeIndex), commandBuffer);
+        commandBuffer.end();
+
+        m_surface->present(*m_context);
+    }
+
+    void mainLoop()
+    {
+        while (!glfwWindowShouldClose(m_window))
+        {
+            glfwPollEvents();
+            render();
+        }
+
+        // wait for device to finish any ongoing commands for safe cleanup
+        m_context->waitIdle();
+    }
+
+    void resizeWindow()
+    {
+        ri::Sizei size;
+        glfwGetWindowSize(m_window, (int*)&size.width, (int*)&size.height);
+
+        if (size && (size != m_surface->size()))
+        {
+            m_surface->recreate(*m_context, size);
+            render();
+        }
+    }
+
+    void cleanup()
+    {
+        glfwDestroyWindow(m_window);
+        glfwTerminate();
+    }
+
+private:
+    GLFWwindow*                              m_window;
+    std::unique_ptr<ri::ApplicationInstance> m_instance;
+    std::unique_ptr<ri::ValidationReport>    m_validation;
+    std::unique_ptr<ri::DeviceContext>       m_context;
+    std::unique_ptr<ri::Surface>             m_surface;
+    std::unique_ptr<ri::ShaderPipeline>      m_shaderPipeline;
+    std::unique_ptr<ri::RenderPipeline>      m_renderPipeline;
+    std::unique_ptr<ri::DescriptorPool>      m_descriptorPool;
+    std::unique_ptr<ri::Buffer>              m_vertexBuffer;
+    std::unique_ptr<ri::Buffer>              m_indexBuffer;
+    std::unique_ptr<ri::Buffer>              m_instanceBuffer;
+    std::unique_ptr<ri::Buffer>              m_transformBuffer;
+    std::unique_ptr<ri::Buffer>              m_meshBuffer;
+    std::unique_ptr<ri::GpuCulling>          m_culling;
+    ri::IndexedVertexDescription             m_vertexDescription;
+    ri::DescriptorSet                        m_descriptor;
+};
+
+int main()
+{
+    DemoApplication app;
+
+    try
+    {
+        app.run();
+    }
+    catch (const std::runtime_error& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
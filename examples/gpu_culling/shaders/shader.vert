@@ -0,0 +1,28 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(std430, binding = 0) readonly buffer Transforms
+{
+    mat4 transforms[];
+};
+
+layout(push_constant) uniform View
+{
+    mat4 viewProjection;
+} view;
+
+layout(location = 0) in vec2 inPosition;
+layout(location = 1) in vec3 inColor;
+
+layout(location = 0) out vec3 fragColor;
+
+out gl_PerVertex {
+    vec4 gl_Position;
+};
+
+void main()
+{
+    fragColor = inColor;
+    // the culling pass writes the instance index as the first instance of each draw
+    gl_Position = view.viewProjection * transforms[gl_InstanceIndex] * vec4(inPosition, 0.0, 1.0);
+}
@@ -10,6 +10,8 @@
  * - using a compute shaders
  * - using and compute pipelines to precompute maps (eg. irradiance, prefiltered, brdf lut) for IBL lighting
  * - changing the image view for a mipmap level of a texture/image target
+ * - reflecting the descriptor layout and push constants of a compute shader
+ * - sharing shader modules through the device's shader module cache
  */
 #define NOMINMAX
 
@@ -41,14 +43,23 @@
 #include <ri/Buffer.h>
 #include <ri/CommandBuffer.h>
 #include <ri/CommandPool.h>
+#include <ri/CommandRecorder.h>
 #include <ri/ComputePipeline.h>
+#include <ri/DescriptorAllocator.h>
+#include <ri/DescriptorLayoutCache.h>
 #include <ri/DescriptorPool.h>
 #include <ri/DescriptorSet.h>
+#include <ri/DescriptorUpdateTemplate.h>
 #include <ri/DeviceContext.h>
+#include <ri/PipelineCache.h>
 #include <ri/RenderPass.h>
 #include <ri/RenderPipeline.h>
+#include <ri/RenderPipelineCache.h>
 #include <ri/RenderTarget.h>
+#include <ri/ShaderModuleCache.h>
 #include <ri/ShaderPipeline.h>
+#include <ri/ShaderReflection.h>
+#include <ri/SpecializationConstants.h>
 #include <ri/Surface.h>
 #include <ri/Texture.h>
 #include <ri/ValidationReport.h>
@@ -56,6 +67,8 @@
 
 const int kWidth  = 800;
 const int kHeight = 600;
+// compiled pipelines saved between runs
+const char* kPipelineCacheFile = "pbr_ibl_pipelines.cache";
 
 struct Vertex
 {
@@ -251,12 +264,9 @@ private:
             if (app->m_activeTexIndex > app->m_prefilteredTexIndex)
                 app->m_activeTexIndex = app->m_skyboxTexIndex;
 
-            const ri::DescriptorSetParams descriptorParams = {
-                {0, app->m_uniformBuffers[0].get(), ri::DescriptorType::eUniformBuffer},
-                {1, app->m_uniformBuffers[1].get(), ri::DescriptorType::eUniformBuffer},
-                {2, app->m_textures[app->m_activeTexIndex].get()}};
-
-            app->m_materials[eSkyboxMaterial].descriptor.update<3>(descriptorParams);
+            const ri::DescriptorUpdateTemplate::Entry entries[] = {
+                {*app->m_uniformBuffers[0]}, {*app->m_uniformBuffers[1]}, {*app->m_textures[app->m_activeTexIndex]}};
+            app->m_skyboxUpdateTemplate->update(app->m_materials[eSkyboxMaterial].descriptor, entries);
             app->record();
         }
 
@@ -337,6 +347,8 @@ private:
         {
             const std::vector<ri::DeviceFeature> requiredFeatures = {
                 ri::DeviceFeature::eSwapchain, ri::DeviceFeature::eAnisotropy, ri::DeviceFeature::eWireframe};
+            // the skybox update template falls back to descriptor writes without it
+            const std::vector<ri::DeviceFeature> optionalFeatures = {ri::DeviceFeature::eDescriptorUpdateTemplate};
             const std::vector<ri::DeviceOperation> requiredOperations = {ri::DeviceOperation::eGraphics,
                                                                          // required for buffer transfer
                                                                          ri::DeviceOperation::eTransfer,
@@ -346,17 +358,20 @@ private:
             ri::DeviceContext::CommandPoolParam param = {ri::DeviceCommandHint::eTransient, true};
 
             m_context.reset(new ri::DeviceContext(*m_instance));
-            m_context->initialize(*m_surface, requiredFeatures, requiredOperations, param);
+            m_context->initialize(*m_surface, requiredFeatures, requiredOperations, param, optionalFeatures);
             m_context->setTagName("MainContext");
+
+            if (!m_context->pipelineCache().load(kPipelineCacheFile))
+                std::cout << "no compatible pipeline cache, compiling all pipelines" << std::endl;
         }
 
-        // create a shader pipeline and let it own the shader modules
+        // create a shader pipeline sharing the cached shader modules
         {
             m_shaderPipeline.reset(new ri::ShaderPipeline());
-            m_shaderPipeline->addStage(
-                new ri::ShaderModule(*m_context, shadersPath + "shader.frag", ri::ShaderStage::eFragment));
-            m_shaderPipeline->addStage(
-                new ri::ShaderModule(*m_context, shadersPath + "shader.vert", ri::ShaderStage::eVertex));
+            // the modules are loaded once and shared by the pipelines
+            auto& shaderModules = m_context->shaderModuleCache();
+            m_shaderPipeline->addStage(shaderModules.get(shadersPath + "shader.frag", ri::ShaderStage::eFragment));
+            m_shaderPipeline->addStage(shaderModules.get(shadersPath + "shader.vert", ri::ShaderStage::eVertex));
 
             m_shaderPipeline->setTagName("BasicShaderPipeline");
         }
@@ -645,6 +660,9 @@ private:
 
             material.descriptor  = m_descriptorPool->create(descriptorLayout.index, descriptorParams);
             descriptorLayouts[1] = descriptorLayout.layout;
+
+            // the environment map is swapped at runtime
+            m_skyboxUpdateTemplate.reset(new ri::DescriptorUpdateTemplate(*m_context, layoutsParams));
         }
 
         // create descriptors and materials
@@ -719,23 +737,22 @@ private:
             params.depthTestEnable      = true;
             params.depthWriteEnable     = true;
 
-            m_renderPipeline.reset(
-                new ri::RenderPipeline(*m_context, pass, *m_shaderPipeline, params, ri::Sizei(kWidth, kHeight)));
+            // identical states are only created once
+            m_renderPipelines.reset(new ri::RenderPipelineCache(*m_context));
+            m_renderPipeline = &m_renderPipelines->get(pass, *m_shaderPipeline, params, ri::Sizei(kWidth, kHeight));
             m_renderPipeline->setTagName("SimplePipeline");
 
             params.polygonMode = ri::PolygonMode::eWireframe;
 
-            m_renderWirePipeline.reset(
-                new ri::RenderPipeline(*m_context, pass, *m_shaderPipeline, params, ri::Sizei(kWidth, kHeight)));
+            m_renderWirePipeline = &m_renderPipelines->get(pass, *m_shaderPipeline, params, ri::Sizei(kWidth, kHeight));
             m_renderWirePipeline->setTagName("WirePipeline");
 
             // create a render pipeline for the skybox
             {
                 std::unique_ptr<ri::ShaderPipeline> shaderPipeline(new ri::ShaderPipeline());
-                shaderPipeline->addStage(
-                    new ri::ShaderModule(*m_context, shadersPath + "skybox.frag", ri::ShaderStage::eFragment));
-                shaderPipeline->addStage(
-                    new ri::ShaderModule(*m_context, shadersPath + "skybox.vert", ri::ShaderStage::eVertex));
+                auto& shaderModules = m_context->shaderModuleCache();
+                shaderPipeline->addStage(shaderModules.get(shadersPath + "skybox.frag", ri::ShaderStage::eFragment));
+                shaderPipeline->addStage(shaderModules.get(shadersPath + "skybox.vert", ri::ShaderStage::eVertex));
                 shaderPipeline->setTagName("SkyboxShaderPipeline");
 
                 params.descriptorLayouts = {descriptorLayouts[1]};
@@ -752,55 +769,57 @@ private:
 
         // create a compute pipelines for precomputing: irradiance map, prefiltered map and brdf LUT
         {
-            std::unique_ptr<ri::DescriptorPool> descriptorPool;
-            descriptorPool.reset(new ri::DescriptorPool(*m_context, 1 + 1 + maxMipLevels,
-                                                        {{ri::DescriptorType::eImage, 2 + 1 * maxMipLevels + 1},
-                                                         {ri::DescriptorType::eCombinedSampler, 1 * maxMipLevels}},
-                                                        ri::DescriptorPool::eFreeDescriptorSet));
+            // the sets are only used by the precompute submission, the pools are reset in bulk once it completes
+            ri::DescriptorAllocator descriptorAllocator(
+                *m_context, {{ri::DescriptorType::eImage, 2}, {ri::DescriptorType::eCombinedSampler, 1}}, 4, 1);
+            descriptorAllocator.beginFrame();
 
             const auto textureSize = m_textures[m_skyboxTexIndex]->size().width;
-
-            ri::CommandBuffer                 commandBuffer = commandPool.begin();
-            std::unique_ptr<ri::ShaderModule> shader;
+            // the kernels workgroup size, specialized as local_size_x_id/local_size_y_id
+            const uint32_t              kGroupSize = 16;
+            ri::SpecializationConstants groupSizeConstants;
+            groupSizeConstants.set(0, kGroupSize).set(1, kGroupSize);
+
+            ri::CommandBuffer                   commandBuffer = commandPool.begin();
+            ri::ShaderModuleCache&              shaderModules = m_context->shaderModuleCache();
+            ri::ShaderModuleCache::SharedModule shader;
             // execute the irradiance compute shader
             {
-                ri::DescriptorLayoutParam              layoutsParams({
+                ri::DescriptorLayoutParam layoutsParams({
                     // skybox cubemap, readonly
                     {0, ri::ShaderStage::eCompute, ri::DescriptorType::eImage},
                     // irradiance cubemap, write only
                     {1, ri::ShaderStage::eCompute, ri::DescriptorType::eImage},
                 });
-                ri::DescriptorPool::CreateLayoutResult descriptorLayout = descriptorPool->createLayout(layoutsParams);
+                const ri::DescriptorSetLayout descriptorLayout = m_context->descriptorLayoutCache().get(layoutsParams);
 
-                shader.reset(
-                    new ri::ShaderModule(*m_context, shadersPath + "irradiance.comp", ri::ShaderStage::eCompute));
-                m_computePipelines[0].reset(new ri::ComputePipeline(*m_context, descriptorLayout.layout, *shader));
+                shader = shaderModules.get(shadersPath + "irradiance.comp", ri::ShaderStage::eCompute);
+                m_computePipelines[0].reset(
+                    new ri::ComputePipeline(*m_context, descriptorLayout, *shader, {}, groupSizeConstants));
                 m_computePipelines[0]->setTagName("IrradianceComputePipeline");
 
                 const ri::DescriptorSetParams descriptorParams = {
                     {0, m_textures[m_skyboxTexIndex].get(), ri::DescriptorSetParams::eImage},
                     {1, m_textures[m_irradianceTexIndex].get(), ri::DescriptorSetParams::eImage}};
-                ri::DescriptorSet descriptor = descriptorPool->create(descriptorLayout.index, descriptorParams);
+                ri::DescriptorSet descriptor =
+                    descriptorAllocator.allocateTransient(descriptorLayout, descriptorParams);
 
                 m_computePipelines[0]->bind(commandBuffer, descriptor);
-                m_computePipelines[0]->dispatch(commandBuffer, textureSize / 16, textureSize / 16, 6);
+                m_computePipelines[0]->dispatch(commandBuffer, textureSize / kGroupSize, textureSize / kGroupSize, 6);
             }
 
             // execute the prefiltered GGX compute shader
             {
-                ri::DescriptorLayoutParam              layoutsParams({
-                    // skybox cubemap, readonly
-                    {0, ri::ShaderStage::eCompute, ri::DescriptorType::eCombinedSampler},
-                    // prefiltered cubemap, write only
-                    {1, ri::ShaderStage::eCompute, ri::DescriptorType::eImage},
-                });
-                ri::DescriptorPool::CreateLayoutResult descriptorLayout = descriptorPool->createLayout(layoutsParams);
+                shader = shaderModules.get(shadersPath + "prefilterGGX.comp", ri::ShaderStage::eCompute);
+
+                // the layout and push constants are reflected from the shader:
+                // skybox cubemap as a combined sampler and the prefiltered cubemap as a storage image
+                const ri::ShaderReflection&   reflection = shader->reflection();
+                const ri::DescriptorSetLayout descriptorLayout =
+                    m_context->descriptorLayoutCache().get(reflection.descriptorLayouts()[0]);
 
-                shader.reset(
-                    new ri::ShaderModule(*m_context, shadersPath + "prefilterGGX.comp", ri::ShaderStage::eCompute));
-                m_computePipelines[1].reset(
-                    new ri::ComputePipeline(*m_context, descriptorLayout.layout, *shader,
-                                            ri::ComputePipeline::PushParams(0, 3 * sizeof(float))));
+                m_computePipelines[1].reset(new ri::ComputePipeline(
+                    *m_context, descriptorLayout, *shader, {reflection.pushConstants()}, groupSizeConstants));
                 m_computePipelines[1]->setTagName("PrefilterComputePipeline");
 
                 ri::DescriptorSetParams descriptorParams = {
@@ -820,32 +839,34 @@ private:
                     m_computePipelines[1]->pushConstants(params, commandBuffer);
 
                     descriptorParams.infos[1].textureInfo.level = mip;  // set the mip target
-                    ri::DescriptorSet descriptor = descriptorPool->create(descriptorLayout.index, descriptorParams);
+                    ri::DescriptorSet descriptor =
+                        descriptorAllocator.allocateTransient(descriptorLayout, descriptorParams);
                     descriptor.bind(commandBuffer, *m_computePipelines[1]);
-                    m_computePipelines[1]->dispatch(commandBuffer, mipmapSize / 16, mipmapSize / 16, 6);
+                    m_computePipelines[1]->dispatch(commandBuffer, mipmapSize / kGroupSize, mipmapSize / kGroupSize, 6);
                 }
             }
 
             // execute the GGX BRDF LUT compute shader
             {
-                ri::DescriptorLayoutParam              layoutsParams({
+                ri::DescriptorLayoutParam layoutsParams({
                     // brdf LUT, write only
                     {0, ri::ShaderStage::eCompute, ri::DescriptorType::eImage},
                 });
-                ri::DescriptorPool::CreateLayoutResult descriptorLayout = descriptorPool->createLayout(layoutsParams);
+                const ri::DescriptorSetLayout descriptorLayout = m_context->descriptorLayoutCache().get(layoutsParams);
 
-                shader.reset(
-                    new ri::ShaderModule(*m_context, shadersPath + "integrateGGX.comp", ri::ShaderStage::eCompute));
-                m_computePipelines[2].reset(new ri::ComputePipeline(*m_context, descriptorLayout.layout, *shader));
+                shader = shaderModules.get(shadersPath + "integrateGGX.comp", ri::ShaderStage::eCompute);
+                m_computePipelines[2].reset(
+                    new ri::ComputePipeline(*m_context, descriptorLayout, *shader, {}, groupSizeConstants));
                 m_computePipelines[2]->setTagName("IntegrateBrdfComputePipeline");
 
                 const ri::DescriptorSetParams descriptorParams = {
                     {0, m_textures[brfdLutTexIndex].get(), ri::DescriptorSetParams::eImage}};
-                ri::DescriptorSet descriptor = descriptorPool->create(descriptorLayout.index, descriptorParams);
+                ri::DescriptorSet descriptor =
+                    descriptorAllocator.allocateTransient(descriptorLayout, descriptorParams);
 
                 const auto textureSize = m_textures[brfdLutTexIndex]->size().width;
                 m_computePipelines[2]->bind(commandBuffer, descriptor);
-                m_computePipelines[2]->dispatch(commandBuffer, textureSize / 16, textureSize / 16, 1);
+                m_computePipelines[2]->dispatch(commandBuffer, textureSize / kGroupSize, textureSize / kGroupSize, 1);
             }
 
             // transition the cubemaps to an optimized format
@@ -857,7 +878,10 @@ private:
             m_textures[brfdLutTexIndex]->transitionImageLayout(layouts, commandBuffer);
 
             commandPool.end(commandBuffer);
+            descriptorAllocator.endFrame(nullptr);
         }
+        // the compute modules aren't needed once their pipelines are created
+        m_context->shaderModuleCache().releaseUnused();
     }
 
     void loadModel(tinygltf::Model& model, const char* filename)
@@ -1014,44 +1038,53 @@ private:
     {
         auto& pipeline = m_useWireframe ? m_renderWirePipeline : m_renderPipeline;
 
-        pipeline->dynamicState().setViewport(commandBuffer, target.size());
-        pipeline->dynamicState().setScissor(commandBuffer, target.size());
-        m_skyboxPipeline->dynamicState().setViewport(commandBuffer, target.size());
-        m_skyboxPipeline->dynamicState().setScissor(commandBuffer, target.size());
+        // skips the binds that don't change the state, all the pipelines have a dynamic viewport and scissor so they
+        // are set once before the binds
+        ri::CommandRecorder recorder(commandBuffer);
+        recorder.setViewport(target.size());
+        recorder.setScissor(target.size());
 
         ri::RenderPass::ScopedEnable passScope(pipeline->defaultPass(), target, commandBuffer);
 
-        pipeline->bind(commandBuffer);
+        recorder.bind(*pipeline);
 
-        // bind the vertex and index buffers
         size_t lastMaterialIndex = m_materials.size();
         for (size_t i = eSkyboxMesh + 1; i < m_meshes.size(); ++i)
         {
             const auto& mesh = m_meshes[i];
-            mesh.vertexDescription.bind(commandBuffer);
+            // bind the vertex and index buffers
+            recorder.bind(mesh.vertexDescription);
 
             assert(mesh.materialIndex != eSkyboxMaterial);
+            const Material& material = m_materials[mesh.materialIndex];
+            // bind the uniform buffer/textures to the render pipeline
+            recorder.bind(material.descriptor, *pipeline);
             if (lastMaterialIndex != mesh.materialIndex)
             {
-                const Material& material = m_materials[mesh.materialIndex];
-                // bind the uniform buffer/textures to the render pipeline
-                material.descriptor.bind(commandBuffer, *pipeline);
                 material.buffer->update(material.ubo);
                 lastMaterialIndex = mesh.materialIndex;
             }
 
-            commandBuffer.drawIndexed(mesh.vertexDescription.count());
+            recorder.drawIndexed(mesh.vertexDescription.count());
         }
 
         // render skybox
         {
-            m_skyboxPipeline->bind(commandBuffer);
+            recorder.bind(*m_skyboxPipeline);
 
             const auto& mesh = m_meshes[eSkyboxMesh];
-            mesh.vertexDescription.bind(commandBuffer);
-            m_materials[mesh.materialIndex].descriptor.bind(commandBuffer, *m_skyboxPipeline);
+            recorder.bind(mesh.vertexDescription);
+            recorder.bind(m_materials[mesh.materialIndex].descriptor, *m_skyboxPipeline);
 
-            commandBuffer.drawIndexed(mesh.vertexDescription.count());
+            recorder.drawIndexed(mesh.vertexDescription.count());
+        }
+
+        // summed over the recorded command buffers
+        const auto& statistics = recorder.statistics();
+        for (size_t i = 0; i < statistics.issued.size(); ++i)
+        {
+            m_recordStatistics.issued[i] += statistics.issued[i];
+            m_recordStatistics.skipped[i] += statistics.skipped[i];
         }
     }
 
@@ -1061,6 +1094,7 @@ private:
 
         m_surface->renderPass().setRenderArea(m_surface->size());
 
+        m_recordStatistics = ri::CommandRecorder::Statistics();
         for (uint32_t index = 0; index < m_surface->swapCount(); ++index)
         {
             auto& commandBuffer = m_surface->commandBuffer(index);
@@ -1069,6 +1103,10 @@ private:
             dispatchCommands(m_surface->renderTarget(index), commandBuffer);
             commandBuffer.end();
         }
+
+        std::cout << "Recorded commands of " << m_surface->swapCount()
+                  << " command buffers, issued: " << m_recordStatistics.totalIssued()
+                  << " skipped: " << m_recordStatistics.totalSkipped() << std::endl;
     }
 
     void update()
@@ -1147,6 +1185,7 @@ private:
 
     void cleanup()
     {
+        m_context->pipelineCache().save(kPipelineCacheFile);
         glfwDestroyWindow(m_window);
         glfwTerminate();
     }
@@ -1158,24 +1197,26 @@ private:
         size_t                       materialIndex = 0;
     };
 
-    GLFWwindow*                                m_window;
-    std::unique_ptr<ri::ApplicationInstance>   m_instance;
-    std::unique_ptr<ri::ValidationReport>      m_validation;
-    std::unique_ptr<ri::DeviceContext>         m_context;
-    std::unique_ptr<ri::Surface>               m_surface;
-    std::unique_ptr<ri::ShaderPipeline>        m_shaderPipeline;
-    std::unique_ptr<ri::RenderPipeline>        m_renderPipeline;
-    std::unique_ptr<ri::RenderPipeline>        m_renderWirePipeline;
-    std::unique_ptr<ri::RenderPipeline>        m_skyboxPipeline;
-    std::unique_ptr<ri::ComputePipeline>       m_computePipelines[5];
-    std::unique_ptr<ri::DescriptorPool>        m_descriptorPool;
-    std::unique_ptr<ri::Buffer>                m_stagingBuffer;
-    std::vector<std::shared_ptr<ri::Buffer> >  m_buffers;
-    std::unique_ptr<ri::Buffer>                m_uniformBuffers[2];
-    std::vector<Mesh>                          m_meshes;
-    std::vector<Material>                      m_materials;
-    std::vector<std::shared_ptr<ri::Texture> > m_textures;
-    std::unique_ptr<ri::RenderTarget>          m_msaaTarget;
+    GLFWwindow*                                   m_window;
+    std::unique_ptr<ri::ApplicationInstance>      m_instance;
+    std::unique_ptr<ri::ValidationReport>         m_validation;
+    std::unique_ptr<ri::DeviceContext>            m_context;
+    std::unique_ptr<ri::Surface>                  m_surface;
+    std::unique_ptr<ri::ShaderPipeline>           m_shaderPipeline;
+    std::unique_ptr<ri::RenderPipelineCache>      m_renderPipelines;
+    ri::RenderPipeline*                           m_renderPipeline     = nullptr;
+    ri::RenderPipeline*                           m_renderWirePipeline = nullptr;
+    std::unique_ptr<ri::RenderPipeline>           m_skyboxPipeline;
+    std::unique_ptr<ri::ComputePipeline>          m_computePipelines[5];
+    std::unique_ptr<ri::DescriptorPool>           m_descriptorPool;
+    std::unique_ptr<ri::DescriptorUpdateTemplate> m_skyboxUpdateTemplate;
+    std::unique_ptr<ri::Buffer>                   m_stagingBuffer;
+    std::vector<std::shared_ptr<ri::Buffer> >     m_buffers;
+    std::unique_ptr<ri::Buffer>                   m_uniformBuffers[2];
+    std::vector<Mesh>                             m_meshes;
+    std::vector<Material>                         m_materials;
+    std::vector<std::shared_ptr<ri::Texture> >    m_textures;
+    std::unique_ptr<ri::RenderTarget>             m_msaaTarget;
 
     using time_t = std::chrono::time_point<std::chrono::steady_clock>;
     struct Bounds
@@ -1201,6 +1242,8 @@ private:
     bool   m_useWireframe = false;
     bool   m_move         = false;
     bool   m_firstMouse   = false;
+
+    ri::CommandRecorder::Statistics m_recordStatistics;
 };
 
 int main()
@@ -0,0 +1,218 @@
+/**
+ *
+ * main.cpp pipeline_benchmark
+ *
+ * Covers the following:
+ * - creating pipelines asynchronously with the pipeline builder
+ * - measuring the pipelines creation time versus the worker threads count
+ * - creation with an empty versus a warm pipeline cache
+ * - frame stalls of new permutations, synchronous creation versus background compilation with a fallback pipeline
+ */
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <ri/ApplicationInstance.h>
+#include <ri/DeviceContext.h>
+#include <ri/PipelineBuilder.h>
+#include <ri/RenderPass.h>
+#include <ri/RenderPipeline.h>
+#include <ri/RenderPipelineCache.h>
+#include <ri/ShaderPipeline.h>
+#include <ri/Surface.h>
+
+const int kWidth  = 320;
+const int kHeight = 240;
+
+class BenchmarkApplication
+{
+public:
+    void run()
+    {
+        initialize();
+
+        std::cout << "pipelines: " << variants().size() << std::endl;
+        const size_t maxThreads = std::max(1u, std::thread::hardware_concurrency());
+        for (size_t threadCount = 1; threadCount <= maxThreads; threadCount *= 2)
+        {
+            // a new device per run, so its pipeline cache is created without initial data
+            const double emptyMs = measure(threadCount, true);
+            const double warmMs  = measure(threadCount, false);
+            std::cout << "threads: " << threadCount << "\tempty cache: " << emptyMs << " ms\twarm: " << warmMs
+                      << " ms" << std::endl;
+        }
+
+        // a new permutation appears every frame
+        const auto syncStatistics = measureFrames(0);
+        std::cout << "sync\tstall: " << syncStatistics.stallTime << " ms\tmax stall: " << syncStatistics.maxStall
+                  << " ms" << std::endl;
+        const auto asyncStatistics = measureFrames(maxThreads);
+        std::cout << "async\tstall: " << asyncStatistics.stallTime << " ms\tmax stall: " << asyncStatistics.maxStall
+                  << " ms\tfallback draws: " << asyncStatistics.fallbacks
+                  << "\tmax pending: " << asyncStatistics.maxPendingTime << " ms" << std::endl;
+
+        cleanup();
+    }
+
+private:
+    void initialize()
+    {
+        glfwInit();
+        glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+        glfwWindowHint(GLFW_VISIBLE, false);
+        m_window = glfwCreateWindow(kWidth, kHeight, "Pipeline benchmark", nullptr, nullptr);
+
+        m_instance.reset(new ri::ApplicationInstance("Pipeline benchmark"));
+    }
+
+    void createContext()
+    {
+        destroyContext();
+
+        // the surface's swapchain is owned by the device
+        m_surface.reset(new ri::Surface(*m_instance, ri::Sizei(kWidth, kHeight), m_window));
+
+        const std::vector<ri::DeviceFeature>   requiredFeatures   = {ri::DeviceFeature::eSwapchain};
+        const std::vector<ri::DeviceOperation> requiredOperations = {ri::DeviceOperation::eGraphics};
+
+        m_context.reset(new ri::DeviceContext(*m_instance));
+        m_context->initialize(*m_surface, requiredFeatures, requiredOperations);
+
+        const std::string shadersPath = "../hello_world/shaders/";
+        m_shaderPipeline.reset(new ri::ShaderPipeline());
+        m_shaderPipeline->addStage(
+            new ri::ShaderModule(*m_context, shadersPath + "shader.frag", ri::ShaderStage::eFragment));
+        m_shaderPipeline->addStage(
+            new ri::ShaderModule(*m_context, shadersPath + "shader.vert", ri::ShaderStage::eVertex));
+
+        ri::RenderPass::AttachmentParams passParams;
+        passParams.format = m_surface->format();
+        m_renderPass.reset(new ri::RenderPass(*m_context, passParams));
+    }
+
+    /// Distinct fixed function states of the same shaders.
+    static std::vector<ri::RenderPipeline::CreateParams> variants()
+    {
+        std::vector<ri::RenderPipeline::CreateParams> result;
+        for (auto topology : {ri::PrimitiveTopology::eTriangles, ri::PrimitiveTopology::eTriangleStrip,
+                              ri::PrimitiveTopology::eLines, ri::PrimitiveTopology::ePoints})
+            for (auto cullMode : {ri::CullMode::eNone, ri::CullMode::eBack, ri::CullMode::eFront})
+                for (int blend = 0; blend < 2; ++blend)
+                    for (int frontFaceCW = 0; frontFaceCW < 2; ++frontFaceCW)
+                    {
+                        ri::RenderPipeline::CreateParams params;
+                        params.primitiveTopology = topology;
+                        params.cullMode          = cullMode;
+                        params.blend             = blend != 0;
+                        params.frontFaceCW       = frontFaceCW != 0;
+                        result.push_back(params);
+                    }
+        return result;
+    }
+
+    ///@param emptyCache Recreates the device with a new empty pipeline cache, otherwise the previous run's cache is
+    /// reused.
+    ///@note Not a cold compilation, the driver's own disk shader cache still serves the pipelines compiled by earlier
+    /// runs, e.g. disable it with MESA_SHADER_CACHE_DISABLE=true or __GL_SHADER_DISK_CACHE=0 to measure a cold start.
+    double measure(size_t threadCount, bool emptyCache)
+    {
+        if (emptyCache || !m_context)
+            createContext();
+
+        const auto                                                   params = variants();
+        std::vector<ri::PipelineBuilder::Future<ri::RenderPipeline>> futures;
+        futures.reserve(params.size());
+
+        const auto start = std::chrono::high_resolution_clock::now();
+        {
+            ri::PipelineBuilder builder(*m_context, threadCount);
+            for (const auto& param : params)
+                futures.push_back(
+                    builder.create(*m_renderPass, *m_shaderPipeline, param, ri::Sizei(kWidth, kHeight)));
+
+            for (auto& future : futures)
+                future.get();
+        }
+        const auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
+
+    ///@param threadCount Compiles the pipelines in the background if not zero.
+    ri::RenderPipelineCache::Statistics measureFrames(size_t threadCount)
+    {
+        createContext();
+
+        // the builder must outlive the cache
+        std::unique_ptr<ri::PipelineBuilder> builder;
+        if (threadCount)
+            builder.reset(new ri::PipelineBuilder(*m_context, threadCount));
+        ri::RenderPipelineCache cache(*m_context, builder.get());
+
+        // the fallback is created upfront, e.g. the default material
+        const auto params = variants();
+        cache.setFallback(&cache.get(*m_renderPass, *m_shaderPipeline, params.front(), ri::Sizei(kWidth, kHeight)));
+        cache.resetStatistics();
+
+        for (size_t frame = 0; frame < params.size(); ++frame)
+        {
+            // draws with all the permutations that appeared so far
+            for (size_t i = 0; i <= frame; ++i)
+                cache.request(*m_renderPass, *m_shaderPipeline, params[i], ri::Sizei(kWidth, kHeight));
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(16));  // rest of the frame
+        }
+
+        cache.finish();
+        return cache.statistics();
+    }
+
+    void destroyContext()
+    {
+        m_shaderPipeline.reset();
+        m_renderPass.reset();
+        m_surface.reset();
+        m_context.reset();
+    }
+
+    void cleanup()
+    {
+        destroyContext();
+        m_instance.reset();
+
+        glfwDestroyWindow(m_window);
+        glfwTerminate();
+    }
+
+private:
+    GLFWwindow*                              m_window = nullptr;
+    std::unique_ptr<ri::ApplicationInstance> m_instance;
+    std::unique_ptr<ri::Surface>             m_surface;
+    std::unique_ptr<ri::DeviceContext>       m_context;
+    std::unique_ptr<ri::RenderPass>          m_renderPass;
+    std::unique_ptr<ri::ShaderPipeline>      m_shaderPipeline;
+};
+
+int main()
+{
+    BenchmarkApplication app;
+
+    try
+    {
+        app.run();
+    }
+    catch (const std::runtime_error& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
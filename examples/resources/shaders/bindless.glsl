@@ -0,0 +1,24 @@
+// Resource arrays of ri::BindlessTable, the including shader must define BINDLESS_SET with the set index the table
+// is bound to. Indices that vary per invocation must be wrapped in nonuniformEXT.
+
+#extension GL_EXT_nonuniform_qualifier : require
+
+#ifndef BINDLESS_SET
+#error "BINDLESS_SET must be defined"
+#endif
+
+layout(set = BINDLESS_SET, binding = 0) uniform sampler2D bindlessTextures[];
+layout(std430, set = BINDLESS_SET, binding = 1) readonly buffer BindlessBuffer
+{
+    uint data[];
+} bindlessBuffers[];
+
+vec4 sampleBindless(uint textureIndex, vec2 uv)
+{
+    return texture(bindlessTextures[nonuniformEXT(textureIndex)], uv);
+}
+
+uint loadBindless(uint bufferIndex, uint offset)
+{
+    return bindlessBuffers[nonuniformEXT(bufferIndex)].data[offset];
+}
@@ -0,0 +1,124 @@
+// Instance culling against the view frustum and optionally a Hi-Z depth pyramid, the visible instances are
+// compacted into indirect draw commands. See ri::GpuCulling for the expected inputs.
+
+layout(local_size_x = 64) in;
+
+struct Instance
+{
+    // object space center and radius
+    vec4 boundingSphere;
+    uint meshIndex;
+};
+
+struct DrawCommand
+{
+    uint indexCount;
+    uint instanceCount;
+    uint firstIndex;
+    int  vertexOffset;
+    uint firstInstance;
+};
+
+layout(binding = 0) uniform View
+{
+    mat4 viewProjection;
+    vec4 frustumPlanes[6];
+    uint instanceCount;
+} view;
+
+layout(std430, binding = 1) readonly buffer Instances
+{
+    Instance instances[];
+};
+
+layout(std430, binding = 2) readonly buffer Transforms
+{
+    mat4 transforms[];
+};
+
+layout(std430, binding = 3) readonly buffer Meshes
+{
+    DrawCommand meshes[];
+};
+
+layout(std430, binding = 4) writeonly buffer Commands
+{
+    DrawCommand commands[];
+};
+
+layout(std430, binding = 5) buffer DrawCount
+{
+    uint drawCount;
+};
+
+#ifdef HIZ_CULLING
+// depth pyramid, each mip holds the farthest depth of the previous one
+layout(binding = 6) uniform sampler2D hiZ;
+
+bool isOccluded(vec3 center, float radius)
+{
+    // project the corners of the sphere bounding box
+    vec3 minBounds = vec3(1.0);
+    vec3 maxBounds = vec3(-1.0);
+    for (int i = 0; i < 8; ++i)
+    {
+        vec3 corner = center + radius * vec3((i & 1) != 0 ? 1.0 : -1.0,
+                                             (i & 2) != 0 ? 1.0 : -1.0,
+                                             (i & 4) != 0 ? 1.0 : -1.0);
+        vec4 clip = view.viewProjection * vec4(corner, 1.0);
+        // intersects the near plane, can't be occluded
+        if (clip.w <= 0.0)
+            return false;
+
+        vec3 ndc  = clip.xyz / clip.w;
+        minBounds = min(minBounds, ndc);
+        maxBounds = max(maxBounds, ndc);
+    }
+
+    vec2 minUv = clamp(minBounds.xy * 0.5 + 0.5, 0.0, 1.0);
+    vec2 maxUv = clamp(maxBounds.xy * 0.5 + 0.5, 0.0, 1.0);
+
+    // select the mip where the bounds cover at most 2x2 texels
+    vec2  size = (maxUv - minUv) * vec2(textureSize(hiZ, 0));
+    float lod  = ceil(log2(max(max(size.x, size.y), 1.0)));
+    lod        = min(lod, float(textureQueryLevels(hiZ) - 1));
+
+    float occluderDepth = max(max(textureLod(hiZ, minUv, lod).r, textureLod(hiZ, vec2(maxUv.x, minUv.y), lod).r),
+                              max(textureLod(hiZ, vec2(minUv.x, maxUv.y), lod).r, textureLod(hiZ, maxUv, lod).r));
+    // nearest depth of the instance is behind all the occluders
+    return minBounds.z > occluderDepth;
+}
+#endif
+
+void main()
+{
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= view.instanceCount)
+        return;
+
+    Instance instance = instances[index];
+    mat4     transform = transforms[index];
+
+    vec3  center = (transform * vec4(instance.boundingSphere.xyz, 1.0)).xyz;
+    float scale  = max(max(length(transform[0].xyz), length(transform[1].xyz)), length(transform[2].xyz));
+    float radius = instance.boundingSphere.w * scale;
+
+    for (int i = 0; i < 6; ++i)
+    {
+        if (dot(view.frustumPlanes[i].xyz, center) + view.frustumPlanes[i].w < -radius)
+            return;
+    }
+
+#ifdef HIZ_CULLING
+    if (isOccluded(center, radius))
+        return;
+#endif
+
+    DrawCommand command   = meshes[instance.meshIndex];
+    command.instanceCount = 1;
+    // the vertex shader fetches the instance data via gl_InstanceIndex
+    command.firstInstance = index;
+
+    uint drawIndex      = atomicAdd(drawCount, 1);
+    commands[drawIndex] = command;
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Config.h"
+#include <string>
 #include <vector>
 #include <util/noncopyable.h>
 
@@ -12,7 +13,13 @@ public:
     ApplicationInstance(const std::string& name, const std::string& engineName = "");
     ~ApplicationInstance();
 
+    /// @return true if the instance extension was enabled at creation.
+    bool extensionEnabled(const char* extensionName) const;
+
+private:
+    std::vector<const char*> getRequiredExtensions(const std::vector<VkExtensionProperties>& availableExtensions);
+
 private:
-    std::vector<const char*> getRequiredExtensions();
+    std::vector<std::string> m_extensions;
 };
 }  // namespace ri
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <vector>
+#include <util/noncopyable.h>
+#include <ri/DescriptorSet.h>
+
+namespace ri
+{
+class Buffer;
+class Texture;
+
+/// Descriptor set with large combined sampler and storage buffer arrays, resources are registered once and the
+/// shaders index the arrays, e.g. by a material id, instead of binding a set per draw.
+///@note Requires the DeviceFeature::eDescriptorIndexing feature, see resources/shaders/bindless.glsl.
+class BindlessTable : util::noncopyable
+{
+public:
+    enum Bindings
+    {
+        eTexturesBinding = 0,
+        eBuffersBinding
+    };
+
+    static const uint32_t kInvalidIndex = ~0u;
+
+    BindlessTable(const DeviceContext& device, uint32_t maxTextures = 4096, uint32_t maxBuffers = 1024);
+    ~BindlessTable();
+
+    /// @return index of the texture in the textures array.
+    uint32_t add(const Texture& texture);
+    /// @return index of the storage buffer in the buffers array.
+    uint32_t add(const Buffer& buffer);
+    /// Replaces the resource at the index, the set may be bound while updating.
+    void update(uint32_t textureIndex, const Texture& texture);
+    void update(uint32_t bufferIndex, const Buffer& buffer);
+    /// The index may be reused after, the shaders must not access it anymore.
+    void removeTexture(uint32_t textureIndex);
+    void removeBuffer(uint32_t bufferIndex);
+
+    DescriptorSetLayout  layout() const;
+    const DescriptorSet& descriptorSet() const;
+    uint32_t             textureCount() const;
+    uint32_t             bufferCount() const;
+
+private:
+    struct Slots
+    {
+        uint32_t              count = 0;
+        uint32_t              maxCount;
+        std::vector<uint32_t> freeIndices;
+
+        uint32_t acquire();
+        void     release(uint32_t index);
+    };
+
+    void write(uint32_t binding, uint32_t index, const VkDescriptorImageInfo* imageInfo,
+               const VkDescriptorBufferInfo* bufferInfo);
+
+private:
+    VkDevice              m_device;
+    VkDescriptorPool      m_pool;
+    VkDescriptorSetLayout m_layout;
+    DescriptorSet         m_descriptor;
+    Slots                 m_textures;
+    Slots                 m_buffers;
+};
+
+inline DescriptorSetLayout BindlessTable::layout() const
+{
+    return m_layout;
+}
+
+inline const DescriptorSet& BindlessTable::descriptorSet() const
+{
+    return m_descriptor;
+}
+
+inline uint32_t BindlessTable::textureCount() const
+{
+    return m_textures.count - m_textures.freeIndices.size();
+}
+
+inline uint32_t BindlessTable::bufferCount() const
+{
+    return m_buffers.count - m_buffers.freeIndices.size();
+}
+}  // namespace ri
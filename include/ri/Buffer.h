@@ -25,6 +25,13 @@ public:
     template <typename T, typename = std::enable_if_t<!std::is_pointer<T>::value> >
     void update(const T& src);
     void write(const void* src, size_t size, size_t offset = 0);
+    /// Writes indirect commands(VkDrawIndirectCommand, VkDrawIndexedIndirectCommand or VkDispatchIndirectCommand)
+    /// tightly packed, starting at the given command index.
+    ///@note For device local buffers write them to a staging buffer and copy.
+    template <typename Command>
+    void writeCommands(const Command* commands, size_t count, size_t firstCommand = 0);
+    template <typename Command>
+    void writeCommands(const std::vector<Command>& commands, size_t firstCommand = 0);
 
     /// Copy from a staging buffer, issues an one time command submit, does this synchronously.
     void copy(const Buffer& src, CommandPool& commandPool, size_t srcOffset = 0, size_t dstOffset = 0);
@@ -110,6 +117,23 @@ inline void Buffer::write(const void* src, size_t size, size_t offset /*= 0*/)
     unlock();
 }
 
+template <typename Command>
+void Buffer::writeCommands(const Command* commands, size_t count, size_t firstCommand /*= 0*/)
+{
+    static_assert(std::is_same<Command, VkDrawIndirectCommand>::value ||
+                      std::is_same<Command, VkDrawIndexedIndirectCommand>::value ||
+                      std::is_same<Command, VkDispatchIndirectCommand>::value,
+                  "INVALID_INDIRECT_COMMAND");
+    assert(commands && count);
+    write(commands, count * sizeof(Command), firstCommand * sizeof(Command));
+}
+
+template <typename Command>
+void Buffer::writeCommands(const std::vector<Command>& commands, size_t firstCommand /*= 0*/)
+{
+    writeCommands(commands.data(), commands.size(), firstCommand);
+}
+
 inline void Buffer::copy(const Buffer& src, CommandPool& commandPool,  //
                          size_t srcOffset /*= 0*/, size_t dstOffset /*= 0*/)
 {
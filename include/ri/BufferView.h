@@ -0,0 +1,60 @@
+#pragma once
+
+#include <util/noncopyable.h>
+#include <ri/Types.h>
+
+namespace ri
+{
+class Buffer;
+
+/// Formatted view of a texel buffer, used for uniform(samplerBuffer) and storage(imageBuffer) texel descriptors.
+class BufferView : util::noncopyable, public RenderObject<VkBufferView>
+{
+public:
+    ///@note The buffer must have the eUniformTexel or eStorageTexel usage and the format must support it.
+    ///@param offset Must be a multiple of the device's minTexelBufferOffsetAlignment.
+    BufferView(const DeviceContext& device, const Buffer& buffer, ColorFormat format, size_t offset = 0,
+               size_t size = VK_WHOLE_SIZE);
+    ~BufferView();
+
+    const Buffer& buffer() const;
+    ColorFormat   format() const;
+    size_t        offset() const;
+    size_t        size() const;
+
+    /// @return true if the format can be used for texel buffers of the given usage.
+    static bool isFormatSupported(const DeviceContext& device, ColorFormat format, bool storage);
+
+private:
+    VkDevice      m_device;
+    const Buffer& m_buffer;
+    ColorFormat   m_format;
+    size_t        m_offset;
+    size_t        m_size;
+};
+
+inline BufferView::~BufferView()
+{
+    vkDestroyBufferView(m_device, m_handle, nullptr);
+}
+
+inline const Buffer& BufferView::buffer() const
+{
+    return m_buffer;
+}
+
+inline ColorFormat BufferView::format() const
+{
+    return m_format;
+}
+
+inline size_t BufferView::offset() const
+{
+    return m_offset;
+}
+
+inline size_t BufferView::size() const
+{
+    return m_size;
+}
+}  // namespace ri
@@ -1,9 +1,14 @@
 #pragma once
 
+#include <ri/Buffer.h>
 #include <ri/Types.h>
 
 namespace ri
 {
+class ComputePipeline;
+class RenderPipeline;
+struct DescriptorSetParams;
+
 class CommandBuffer : public RenderObject<VkCommandBuffer>
 {
 public:
@@ -21,33 +26,68 @@ public:
     void draw(uint32_t vertexCount, uint32_t instanceCount = 1,  //
               uint32_t offsetVertexIndex = 0, uint32_t offsetInstanceIndex = 0);
     void drawIndexed(uint32_t vertexCount, uint32_t instanceCount = 1,  //
-                     uint32_t offsetIndex = 0, uint32_t offsetVertexIndex = 0, uint32_t offsetInstanceIndex = 0);
+                     uint32_t offsetIndex = 0, int32_t offsetVertexIndex = 0, uint32_t offsetInstanceIndex = 0);
+
+    /// Draws with the parameters read from a buffer of VkDrawIndirectCommand.
+    ///@note A drawCount greater than one requires the DeviceFeature::eMultiDrawIndirect feature.
+    void drawIndirect(const Buffer& buffer, uint32_t drawCount, size_t offset = 0,
+                      uint32_t stride = sizeof(VkDrawIndirectCommand));
+    /// Draws with the parameters read from a buffer of VkDrawIndexedIndirectCommand.
+    void drawIndexedIndirect(const Buffer& buffer, uint32_t drawCount, size_t offset = 0,
+                             uint32_t stride = sizeof(VkDrawIndexedIndirectCommand));
+    /// Draws with the draw count read from countBuffer, clamped to maxDrawCount.
+    ///@note Requires the DeviceFeature::eDrawIndirectCount feature.
+    void drawIndirectCount(const Buffer& buffer, const Buffer& countBuffer, uint32_t maxDrawCount,
+                           size_t offset = 0, size_t countOffset = 0,
+                           uint32_t stride = sizeof(VkDrawIndirectCommand));
+    void drawIndexedIndirectCount(const Buffer& buffer, const Buffer& countBuffer, uint32_t maxDrawCount,
+                                  size_t offset = 0, size_t countOffset = 0,
+                                  uint32_t stride = sizeof(VkDrawIndexedIndirectCommand));
+    /// Dispatches with the group counts read from a VkDispatchIndirectCommand.
+    void dispatchIndirect(const Buffer& buffer, size_t offset = 0);
+
+    /// Writes the descriptors directly into the command buffer, no descriptor set is allocated.
+    ///@param setIndex Set of the pipeline layout, must be created with DescriptorLayoutParam::ePushDescriptor.
+    ///@note Requires the DeviceFeature::ePushDescriptor feature.
+    void pushDescriptors(const RenderPipeline& pipeline, uint32_t setIndex, const DescriptorSetParams& params);
+    void pushDescriptors(const ComputePipeline& pipeline, uint32_t setIndex, const DescriptorSetParams& params);
 
     ///@note Can only be used if the buffer was created from a pool with reset mode.
     void reset(ResetFlags flags = ePreserve);
     void destroy();
 
 private:
-    CommandBuffer(VkDevice device, VkCommandPool commandPool, VkCommandBuffer handle);
-    CommandBuffer(VkDevice device, VkCommandPool commandPool, bool isPrimary);
+    CommandBuffer(VkDevice device, VkCommandPool commandPool, const detail::DeviceFunctions* functions,
+                  VkCommandBuffer handle);
+    CommandBuffer(VkDevice device, VkCommandPool commandPool, const detail::DeviceFunctions* functions,
+                  bool isPrimary);
+
+    void pushDescriptors(VkPipelineBindPoint bindPoint, VkPipelineLayout layout, uint32_t setIndex,
+                         const DescriptorSetParams& params);
 
 private:
-    VkCommandPool m_commandPool = VK_NULL_HANDLE;
-    VkDevice      m_device      = VK_NULL_HANDLE;
+    VkCommandPool                  m_commandPool = VK_NULL_HANDLE;
+    VkDevice                       m_device      = VK_NULL_HANDLE;
+    const detail::DeviceFunctions* m_functions   = nullptr;
 
     friend class CommandPool;  // command buffers can only be constructed from a pool
+    friend const detail::DeviceFunctions& detail::getDeviceFunctions(const ri::CommandBuffer& buffer);
 };
 
-inline CommandBuffer::CommandBuffer(VkDevice device, VkCommandPool commandPool, VkCommandBuffer handle)
+inline CommandBuffer::CommandBuffer(VkDevice device, VkCommandPool commandPool,
+                                    const detail::DeviceFunctions* functions, VkCommandBuffer handle)
     : RenderObject<VkCommandBuffer>(handle)
     , m_commandPool(commandPool)
     , m_device(device)
+    , m_functions(functions)
 {
 }
 
-inline CommandBuffer::CommandBuffer(VkDevice device, VkCommandPool commandPool, bool isPrimary)
+inline CommandBuffer::CommandBuffer(VkDevice device, VkCommandPool commandPool,
+                                    const detail::DeviceFunctions* functions, bool isPrimary)
     : m_commandPool(commandPool)
     , m_device(device)
+    , m_functions(functions)
 {
     static_assert(offsetof(CommandBuffer, m_handle) == offsetof(detail::CommandBufferStorage, m_handle),
                   "INVALID_FORMAT");
@@ -55,6 +95,8 @@ inline CommandBuffer::CommandBuffer(VkDevice device, VkCommandPool commandPool,
                   "INVALID_FORMAT");
     static_assert(offsetof(CommandBuffer, m_device) == offsetof(detail::CommandBufferStorage, m_device),
                   "INVALID_FORMAT");
+    static_assert(offsetof(CommandBuffer, m_functions) == offsetof(detail::CommandBufferStorage, m_functions),
+                  "INVALID_FORMAT");
     static_assert(sizeof(CommandBuffer) == sizeof(detail::CommandBufferStorage), "INVALID_FORMAT");
 
     VkCommandBufferAllocateInfo allocInfo = {};
@@ -82,11 +124,58 @@ inline void CommandBuffer::draw(uint32_t vertexCount, uint32_t instanceCount,  /
 }
 
 inline void CommandBuffer::drawIndexed(uint32_t vertexCount, uint32_t instanceCount,  //
-                                       uint32_t offsetIndex, uint32_t offsetVertexIndex, uint32_t offsetInstanceIndex)
+                                       uint32_t offsetIndex, int32_t offsetVertexIndex, uint32_t offsetInstanceIndex)
 {
     vkCmdDrawIndexed(m_handle, vertexCount, instanceCount, offsetIndex, offsetVertexIndex, offsetInstanceIndex);
 }
 
+inline void CommandBuffer::drawIndirect(const Buffer& buffer, uint32_t drawCount, size_t offset /*= 0*/,
+                                        uint32_t stride /*= sizeof(VkDrawIndirectCommand)*/)
+{
+    assert(buffer.bufferUsage().get() & BufferUsageFlags::eIndirect);
+    assert((offset + stride * (drawCount ? drawCount - 1 : 0) + sizeof(VkDrawIndirectCommand)) <= buffer.bytes());
+    vkCmdDrawIndirect(m_handle, detail::getVkHandle(buffer), offset, drawCount, stride);
+}
+
+inline void CommandBuffer::drawIndexedIndirect(const Buffer& buffer, uint32_t drawCount, size_t offset /*= 0*/,
+                                               uint32_t stride /*= sizeof(VkDrawIndexedIndirectCommand)*/)
+{
+    assert(buffer.bufferUsage().get() & BufferUsageFlags::eIndirect);
+    assert((offset + stride * (drawCount ? drawCount - 1 : 0) + sizeof(VkDrawIndexedIndirectCommand)) <=
+           buffer.bytes());
+    vkCmdDrawIndexedIndirect(m_handle, detail::getVkHandle(buffer), offset, drawCount, stride);
+}
+
+inline void CommandBuffer::drawIndirectCount(const Buffer& buffer, const Buffer& countBuffer, uint32_t maxDrawCount,
+                                             size_t offset /*= 0*/, size_t countOffset /*= 0*/,
+                                             uint32_t stride /*= sizeof(VkDrawIndirectCommand)*/)
+{
+    assert(m_functions && m_functions->cmdDrawIndirectCount);
+    assert(buffer.bufferUsage().get() & BufferUsageFlags::eIndirect);
+    assert(countBuffer.bufferUsage().get() & BufferUsageFlags::eIndirect);
+    m_functions->cmdDrawIndirectCount(m_handle, detail::getVkHandle(buffer), offset, detail::getVkHandle(countBuffer),
+                                      countOffset, maxDrawCount, stride);
+}
+
+inline void CommandBuffer::drawIndexedIndirectCount(const Buffer& buffer, const Buffer& countBuffer,
+                                                    uint32_t maxDrawCount, size_t offset /*= 0*/,
+                                                    size_t   countOffset /*= 0*/,
+                                                    uint32_t stride /*= sizeof(VkDrawIndexedIndirectCommand)*/)
+{
+    assert(m_functions && m_functions->cmdDrawIndexedIndirectCount);
+    assert(buffer.bufferUsage().get() & BufferUsageFlags::eIndirect);
+    assert(countBuffer.bufferUsage().get() & BufferUsageFlags::eIndirect);
+    m_functions->cmdDrawIndexedIndirectCount(m_handle, detail::getVkHandle(buffer), offset,
+                                             detail::getVkHandle(countBuffer), countOffset, maxDrawCount, stride);
+}
+
+inline void CommandBuffer::dispatchIndirect(const Buffer& buffer, size_t offset /*= 0*/)
+{
+    assert(buffer.bufferUsage().get() & BufferUsageFlags::eIndirect);
+    assert((offset + sizeof(VkDispatchIndirectCommand)) <= buffer.bytes());
+    vkCmdDispatchIndirect(m_handle, detail::getVkHandle(buffer), offset);
+}
+
 inline void CommandBuffer::begin(RecordFlags flags)
 {
     VkCommandBufferBeginInfo beginInfo = {};
@@ -107,4 +196,13 @@ inline void CommandBuffer::reset(ResetFlags flags /*= ePreserve*/)
     vkResetCommandBuffer(m_handle, flags);
 }
 
+namespace detail
+{
+    inline const DeviceFunctions& getDeviceFunctions(const ri::CommandBuffer& buffer)
+    {
+        assert(buffer.m_functions);
+        return *buffer.m_functions;
+    }
+}  // namespace detail
+
 }  // namespace ri
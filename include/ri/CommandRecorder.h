@@ -0,0 +1,194 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <vector>
+#include <util/noncopyable.h>
+#include <ri/Size.h>
+#include <ri/Types.h>
+
+namespace ri
+{
+class Buffer;
+class CommandBuffer;
+class ComputePipeline;
+class DescriptorSet;
+class IndexedVertexDescription;
+class RenderPipeline;
+class VertexDescription;
+
+/// Records into a command buffer while tracking the bound state, calls that wouldn't change the state are skipped.
+///@note Commands recorded directly into the command buffer aren't tracked, call reset after doing so.
+///@note Binding another render pipeline forgets the tracked viewport and scissor, the next set calls are issued.
+class CommandRecorder : util::noncopyable
+{
+public:
+    enum StateType
+    {
+        ePipeline = 0,
+        eDescriptorSet,
+        eVertexBuffers,
+        eIndexBuffer,
+        eViewport,
+        eScissor,
+        ePushConstants,
+        eStateTypeCount
+    };
+
+    struct Statistics
+    {
+        // calls per state type
+        std::array<uint32_t, eStateTypeCount> issued;
+        std::array<uint32_t, eStateTypeCount> skipped;
+
+        Statistics();
+
+        uint32_t totalIssued() const;
+        uint32_t totalSkipped() const;
+    };
+
+    CommandRecorder(CommandBuffer& buffer);
+
+    CommandBuffer& commandBuffer();
+    /// Forgets the tracked state, the statistics are kept.
+    void reset();
+
+    const Statistics& statistics() const;
+    void              resetStatistics();
+
+    void bind(const RenderPipeline& pipeline);
+    void bind(const ComputePipeline& pipeline);
+    ///@param dynamicOffsets One offset per dynamic buffer descriptor of the set, binds with new offsets aren't skipped.
+    void bind(const DescriptorSet& descriptor, const RenderPipeline& pipeline, uint32_t setIndex = 0,
+              const uint32_t* dynamicOffsets = nullptr, uint32_t dynamicOffsetCount = 0);
+    void bind(const DescriptorSet& descriptor, const ComputePipeline& pipeline, uint32_t setIndex = 0,
+              const uint32_t* dynamicOffsets = nullptr, uint32_t dynamicOffsetCount = 0);
+    void bind(const VertexDescription& description);
+    /// Binds both the vertex and index buffers.
+    void bind(const IndexedVertexDescription& description);
+    void bindIndexBuffer(const Buffer& buffer, IndexType indexType, size_t offset = 0);
+
+    void setViewport(const Sizei& viewportSize, int32_t viewportX = 0, int32_t viewportY = 0, float minDepth = 0.f,
+                     float maxDepth = 1.f);
+    void setScissor(const Sizei& viewportSize, int32_t viewportX = 0, int32_t viewportY = 0);
+
+    void pushConstants(const RenderPipeline& pipeline, ShaderStage stages, const void* src, uint32_t offset,
+                       uint32_t size);
+    void pushConstants(const ComputePipeline& pipeline, const void* src, uint32_t offset, uint32_t size);
+
+    void draw(uint32_t vertexCount, uint32_t instanceCount = 1,  //
+              uint32_t offsetVertexIndex = 0, uint32_t offsetInstanceIndex = 0);
+    void drawIndexed(uint32_t indexCount, uint32_t instanceCount = 1,  //
+                     uint32_t offsetIndex = 0, int32_t offsetVertexIndex = 0, uint32_t offsetInstanceIndex = 0);
+
+private:
+    static const size_t kMaxDescriptorSets = 8;
+    static const size_t kMaxVertexBuffers  = 16;
+    static const size_t kMaxDynamicOffsets = 8;
+
+    enum BindPoint
+    {
+        eGraphics = 0,
+        eCompute,
+        eBindPointCount
+    };
+
+    struct DescriptorSetState
+    {
+        VkDescriptorSet                          handle = VK_NULL_HANDLE;
+        VkPipelineLayout                         layout = VK_NULL_HANDLE;
+        std::array<uint32_t, kMaxDynamicOffsets> dynamicOffsets;
+        uint32_t                                 dynamicOffsetCount = 0;
+
+        bool equal(VkDescriptorSet handle, VkPipelineLayout layout, const uint32_t* dynamicOffsets,
+                   uint32_t dynamicOffsetCount) const;
+    };
+
+    struct PushConstantState
+    {
+        VkShaderStageFlags   stages;
+        uint32_t             offset;
+        std::vector<uint8_t> data;
+    };
+
+    struct BindPointState
+    {
+        VkPipeline                                         pipeline = VK_NULL_HANDLE;
+        std::array<DescriptorSetState, kMaxDescriptorSets> descriptorSets;
+        VkPipelineLayout                                   pushLayout = VK_NULL_HANDLE;
+        std::vector<PushConstantState>                     pushConstants;
+    };
+
+    void bind(BindPoint bindPoint, VkPipeline pipeline);
+    void bind(BindPoint bindPoint, VkDescriptorSet descriptor, VkPipelineLayout layout, uint32_t setIndex,
+              const uint32_t* dynamicOffsets, uint32_t dynamicOffsetCount);
+    void pushConstants(BindPoint bindPoint, VkPipelineLayout layout, VkShaderStageFlags stages, const void* src,
+                       uint32_t offset, uint32_t size);
+    bool track(StateType type, bool changed);
+
+private:
+    CommandBuffer*                              m_buffer;
+    Statistics                                  m_statistics;
+    std::array<BindPointState, eBindPointCount> m_bindPoints;
+    std::array<VkBuffer, kMaxVertexBuffers>     m_vertexBuffers;
+    std::array<VkDeviceSize, kMaxVertexBuffers> m_vertexBufferOffsets;
+    detail::IndexBufferInfo                     m_indexBuffer;
+    VkViewport                                  m_viewport;
+    VkRect2D                                    m_scissor;
+    bool                                        m_hasViewport;
+    bool                                        m_hasScissor;
+};
+
+inline CommandRecorder::Statistics::Statistics()
+{
+    issued.fill(0);
+    skipped.fill(0);
+}
+
+inline uint32_t CommandRecorder::Statistics::totalIssued() const
+{
+    uint32_t total = 0;
+    for (auto count : issued)
+        total += count;
+    return total;
+}
+
+inline uint32_t CommandRecorder::Statistics::totalSkipped() const
+{
+    uint32_t total = 0;
+    for (auto count : skipped)
+        total += count;
+    return total;
+}
+
+inline bool CommandRecorder::DescriptorSetState::equal(VkDescriptorSet handle, VkPipelineLayout layout,
+                                                      const uint32_t* dynamicOffsets, uint32_t dynamicOffsetCount) const
+{
+    return this->handle == handle && this->layout == layout && this->dynamicOffsetCount == dynamicOffsetCount &&
+           std::equal(dynamicOffsets, dynamicOffsets + dynamicOffsetCount, this->dynamicOffsets.begin());
+}
+
+inline CommandBuffer& CommandRecorder::commandBuffer()
+{
+    return *m_buffer;
+}
+
+inline const CommandRecorder::Statistics& CommandRecorder::statistics() const
+{
+    return m_statistics;
+}
+
+inline void CommandRecorder::resetStatistics()
+{
+    m_statistics = Statistics();
+}
+
+inline bool CommandRecorder::track(StateType type, bool changed)
+{
+    if (changed)
+        ++m_statistics.issued[type];
+    else
+        ++m_statistics.skipped[type];
+    return changed;
+}
+}  // namespace ri
@@ -12,6 +12,7 @@ class DeviceContext;
 class ShaderModule;
 class VertexDescription;
 class DescriptorSet;
+class SpecializationConstants;
 
 class ComputePipeline : util::noncopyable, public RenderObject<VkPipeline>
 {
@@ -45,6 +46,14 @@ public:
                     const std::vector<PushParams>& pushConstants,     //
                     const std::string&             procedureName = "main");
 
+    ///@param constants The specialization constants, e.g. the workgroup size with local_size_x_id.
+    ComputePipeline(const ri::DeviceContext&       device,            //
+                    DescriptorSetLayout            descriptorLayout,  //
+                    const ri::ShaderModule&        shaderModule,      //
+                    const std::vector<PushParams>& pushConstants,     //
+                    const SpecializationConstants& constants,         //
+                    const std::string&             procedureName = "main");
+
     ~ComputePipeline();
 
     void bind(CommandBuffer& buffer) const;
@@ -58,8 +67,10 @@ public:
     void pushConstants(const T& data, size_t offset, CommandBuffer& buffer);
 
 private:
-    VkPipelineLayout createLayout(const VkDevice device, const std::vector<VkDescriptorSetLayout>& descriptorLayouts,
-                                  const std::vector<PushParams>& pushConstants);
+    /// Returns the shared layout from the device's pipeline layout cache.
+    static VkPipelineLayout createLayout(const ri::DeviceContext&                  device,
+                                         const std::vector<VkDescriptorSetLayout>& descriptorLayouts,
+                                         const std::vector<PushParams>&            pushConstants);
 
 private:
     VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <vector>
+#include <util/noncopyable.h>
+#include <ri/DescriptorPool.h>
+
+namespace ri
+{
+class DescriptorSet;
+class Fence;
+struct DescriptorSetParams;
+
+/// Allocates descriptor sets from a chain of pools that grows with the demand.
+/// Transient sets are allocated from per frame pools, which are recycled in bulk once the frame's fence is signaled.
+class DescriptorAllocator : util::noncopyable
+{
+public:
+    typedef DescriptorPool::TypeSize TypeSize;
+
+    ///@param setSizes Descriptors count of each type expected per set, used for sizing the pools.
+    ///@param setsPerPool Sets count of the first pool, each chained pool doubles it.
+    ///@param frameCount Number of frames in flight that use transient sets.
+    DescriptorAllocator(const DeviceContext& device, const std::vector<TypeSize>& setSizes, uint32_t setsPerPool = 64,
+                        uint32_t frameCount = 2);
+    ~DescriptorAllocator();
+
+    /// Allocates a set that's valid until the allocator is reset.
+    DescriptorSet allocate(DescriptorSetLayout layout);
+    ///@note Also calls descriptor update.
+    DescriptorSet allocate(DescriptorSetLayout layout, const DescriptorSetParams& params);
+    /// Allocates a set that's valid until the current frame's submission completes.
+    ///@note Must be called between beginFrame and endFrame.
+    DescriptorSet allocateTransient(DescriptorSetLayout layout);
+    ///@note Also calls descriptor update.
+    DescriptorSet allocateTransient(DescriptorSetLayout layout, const DescriptorSetParams& params);
+
+    /// Advances to the next frame, waits for its previous fence and then recycles its transient pools.
+    void beginFrame();
+    ///@param fence Signaled when the frame's submission completes, nullptr if it's already complete.
+    ///@note The fence must be alive until the frame is begun again.
+    void endFrame(const Fence* fence);
+
+    /// Recycles all the pools, previously allocated sets become invalid.
+    ///@note Waits for the pending frames.
+    void reset();
+
+    size_t poolCount() const;
+
+private:
+    struct Frame
+    {
+        std::vector<VkDescriptorPool> pools;
+        const Fence*                  fence = nullptr;
+    };
+
+    DescriptorSet    allocate(std::vector<VkDescriptorPool>& pools, DescriptorSetLayout layout);
+    VkDescriptorPool acquirePool();
+    void             recycle(std::vector<VkDescriptorPool>& pools);
+
+private:
+    VkDevice                      m_device;
+    std::vector<TypeSize>         m_setSizes;
+    uint32_t                      m_nextSetsPerPool;
+    size_t                        m_poolCount = 0;
+    std::vector<VkDescriptorPool> m_pools;
+    std::vector<VkDescriptorPool> m_freePools;
+    std::vector<Frame>            m_frames;
+    uint32_t                      m_frameIndex;
+    bool                          m_frameActive = false;
+};
+
+inline size_t DescriptorAllocator::poolCount() const
+{
+    return m_poolCount;
+}
+}  // namespace ri
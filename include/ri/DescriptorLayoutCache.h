@@ -0,0 +1,52 @@
+#pragma once
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <util/noncopyable.h>
+#include <ri/DescriptorPool.h>
+
+namespace ri
+{
+/// Device wide cache of descriptor set layouts, identical layout params share the same layout handle.
+///@note Owned by the DeviceContext, the layouts are destroyed with the device.
+class DescriptorLayoutCache : util::noncopyable
+{
+public:
+    DescriptorLayoutCache(VkDevice device);
+    ~DescriptorLayoutCache();
+
+    /// Returns the cached layout or creates a new one, the bindings order doesn't matter.
+    ///@note Thread safe.
+    DescriptorSetLayout get(const DescriptorLayoutParam& param);
+
+    size_t size() const;
+
+    static size_t hash(const DescriptorLayoutParam& param);
+
+private:
+    struct Entry
+    {
+        std::vector<DescriptorBinding>  bindings;
+        DescriptorLayoutParam::FlagType flags;
+        DescriptorSetLayout             layout;
+    };
+
+    static std::vector<DescriptorBinding> sortedBindings(const DescriptorLayoutParam& param);
+    static size_t hashBindings(const std::vector<DescriptorBinding>& bindings, DescriptorLayoutParam::FlagType flags);
+    static bool equal(const std::vector<DescriptorBinding>& lhs, const std::vector<DescriptorBinding>& rhs);
+
+private:
+    VkDevice m_device;
+    // entries with the same hash are kept in the bucket
+    std::unordered_map<size_t, std::vector<Entry>> m_layouts;
+    size_t                                         m_layoutCount = 0;
+    mutable std::mutex                             m_mutex;
+};
+
+inline size_t DescriptorLayoutCache::size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_layoutCount;
+}
+}  // namespace ri
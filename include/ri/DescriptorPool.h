@@ -6,6 +6,7 @@
 namespace ri
 {
 class DescriptorSet;
+class DescriptorLayoutCache;
 struct DescriptorSetParams;
 
 struct DescriptorBinding
@@ -13,27 +14,40 @@ struct DescriptorBinding
     uint32_t       index = 0;
     int            stageFlags;  // see ri::ShaderStage
     DescriptorType type;
+    // number of array elements
+    uint32_t count = 1;
 
     DescriptorBinding() {}
-    DescriptorBinding(uint32_t index, int stageFlags, DescriptorType type)
+    DescriptorBinding(uint32_t index, int stageFlags, DescriptorType type, uint32_t count = 1)
         : index(index)
         , stageFlags(stageFlags)
         , type(type)
+        , count(count)
     {
     }
 };
 
 struct DescriptorLayoutParam
 {
+    enum FlagType
+    {
+        eNone = 0,
+        // the set's descriptors are pushed to a command buffer instead of allocated, see CommandBuffer::pushDescriptors
+        ePushDescriptor = VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR
+    };
+
     std::vector<DescriptorBinding> bindings;
+    FlagType                       flags = eNone;
 
     DescriptorLayoutParam() {}
-    DescriptorLayoutParam(const DescriptorBinding& binding)
+    DescriptorLayoutParam(const DescriptorBinding& binding, FlagType flags = eNone)
         : bindings(1, binding)
+        , flags(flags)
     {
     }
-    DescriptorLayoutParam(std::initializer_list<DescriptorBinding> list)
+    DescriptorLayoutParam(std::initializer_list<DescriptorBinding> list, FlagType flags = eNone)
         : bindings(list.begin(), list.end())
+        , flags(flags)
     {
     }
 };
@@ -60,7 +74,6 @@ public:
                    size_t availableDescriptorsCount, FlagType flags = eNone);
     DescriptorPool(const DeviceContext& device, size_t poolSize, const std::vector<TypeSize>& availableDescriptors,
                    FlagType flags = eNone);
-    ///@warning The RenderPipeline that use the layout descriptors must be destroyed before the pool.
     ~DescriptorPool();
 
     DescriptorSet create(uint32_t layoutIndex);
@@ -71,7 +84,7 @@ public:
     void          free(const DescriptorSet& descriptor);
     void          free(const DescriptorSet* descriptors, uint32_t count);
 
-    ///@note New layout will be appended.
+    ///@note New layout will be appended, the layout handle is shared through the device layout cache.
     CreateLayoutResult createLayout(const DescriptorLayoutParam& param);
     ///@note New layouts will be appended.
     size_t createLayouts(const DescriptorLayoutParam* layoutParams, size_t layoutParamsCount);
@@ -80,8 +93,10 @@ public:
     const std::vector<DescriptorSetLayout>& layouts() const;
 
 private:
-    VkDevice m_device = VK_NULL_HANDLE;
+    VkDevice               m_device      = VK_NULL_HANDLE;
+    DescriptorLayoutCache* m_layoutCache = nullptr;
 
+    // owned by the layout cache
     std::vector<VkDescriptorSetLayout> m_descriptorLayouts;
 };
 
@@ -99,7 +114,7 @@ inline void DescriptorPool::create(const std::vector<uint32_t>& layoutIndices, s
 
 inline size_t DescriptorPool::createLayouts(const std::vector<DescriptorLayoutParam>& layoutParams)
 {
-    createLayouts(layoutParams.data(), layoutParams.size());
+    return createLayouts(layoutParams.data(), layoutParams.size());
 }
 
 inline const std::vector<DescriptorSetLayout>& DescriptorPool::layouts() const
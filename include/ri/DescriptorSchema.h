@@ -0,0 +1,311 @@
+#pragma once
+
+#include <array>
+#include <tuple>
+#include <type_traits>
+#include <ri/DescriptorLayoutCache.h>
+#include <ri/DescriptorSet.h>
+#include <ri/DeviceContext.h>
+
+namespace ri
+{
+/// Compile time description of a set's binding.
+///@param Stages See ri::ShaderStage.
+///@param Count Number of array elements.
+template <uint32_t Index, int Stages, DescriptorType::type Type, uint32_t Count = 1>
+struct SchemaBinding
+{
+    static const uint32_t             index      = Index;
+    static const int                  stageFlags = Stages;
+    static const DescriptorType::type type       = Type;
+    static const uint32_t             count      = Count;
+
+    static_assert(Count > 0, "INVALID_DESCRIPTOR_COUNT");
+    // separate samplers have no resource to write
+    static_assert(Type != DescriptorType::eSampler, "UNSUPPORTED_DESCRIPTOR_TYPE");
+};
+
+namespace detail
+{
+    /// Resource type written to a descriptor type.
+    template <DescriptorType::type Type>
+    struct SchemaResource
+    {
+        typedef Buffer type;
+    };
+    template <>
+    struct SchemaResource<DescriptorType::eCombinedSampler>
+    {
+        typedef Texture type;
+    };
+    template <>
+    struct SchemaResource<DescriptorType::eSampledImage> : SchemaResource<DescriptorType::eCombinedSampler>
+    {
+    };
+    template <>
+    struct SchemaResource<DescriptorType::eImage> : SchemaResource<DescriptorType::eCombinedSampler>
+    {
+    };
+    template <>
+    struct SchemaResource<DescriptorType::eTexelBuffer>
+    {
+        typedef BufferView type;
+    };
+    template <>
+    struct SchemaResource<DescriptorType::eUniformTexelBuffer> : SchemaResource<DescriptorType::eTexelBuffer>
+    {
+    };
+
+    template <class... Bindings>
+    struct SchemaCount;
+    template <>
+    struct SchemaCount<>
+    {
+        static const uint32_t value = 0;
+    };
+    template <class Binding, class... Bindings>
+    struct SchemaCount<Binding, Bindings...>
+    {
+        static const uint32_t value = Binding::count + SchemaCount<Bindings...>::value;
+    };
+}  // namespace detail
+
+/// Describes a set's bindings once, both the layout and the writes are generated from it.
+/// Usage:
+/// typedef ri::DescriptorSchema<
+///     ri::SchemaBinding<0, ri::ShaderStage::eVertex, ri::DescriptorType::eUniformBuffer>,
+///     ri::SchemaBinding<1, ri::ShaderStage::eFragment, ri::DescriptorType::eCombinedSampler, 4> > MaterialSchema;
+///
+/// MaterialSchema::Writes writes;
+/// writes.set<0>(uniformBuffer);
+/// writes.set<1>(albedoTexture, 0);
+/// ...
+/// // the dynamic buffer types need the range seen by a draw, the bind offsets are added to its offset
+/// writes.set<2>(instancesBuffer, 0, sizeof(InstanceData));
+/// writes.update(descriptorSet);
+template <class... Bindings>
+class DescriptorSchema
+{
+public:
+    static const size_t   kBindingCount    = sizeof...(Bindings);
+    static const uint32_t kDescriptorCount = detail::SchemaCount<Bindings...>::value;
+
+    template <size_t I>
+    using Binding = typename std::tuple_element<I, std::tuple<Bindings...> >::type;
+    template <size_t I>
+    using Resource = typename detail::SchemaResource<Binding<I>::type>::type;
+
+    static_assert(kBindingCount > 0, "EMPTY_SCHEMA");
+
+    /// Layout bindings generated at compile time.
+    static constexpr VkDescriptorSetLayoutBinding kLayoutBindings[kBindingCount] = {
+        {Bindings::index, (VkDescriptorType)Bindings::type, Bindings::count, (VkShaderStageFlags)Bindings::stageFlags,
+         nullptr}...};
+
+    static DescriptorLayoutParam layoutParam(DescriptorLayoutParam::FlagType flags = DescriptorLayoutParam::eNone);
+    /// Returns the schema's layout from the device layout cache.
+    static DescriptorSetLayout layout(const DeviceContext& device,
+                                      DescriptorLayoutParam::FlagType flags = DescriptorLayoutParam::eNone);
+
+    /// Strongly typed writes of all the schema's descriptors, updating doesn't allocate.
+    class Writes
+    {
+    public:
+        Writes();
+
+        ///@param arrayElement Element of the binding's array.
+        ///@note Writes the whole resource, the dynamic buffer types must set a range instead.
+        template <size_t I>
+        void set(const Resource<I>* resource, uint32_t arrayElement = 0);
+        /// Writes a range of the buffer.
+        template <size_t I>
+        void set(const Buffer* buffer, uint32_t offset, uint32_t size, uint32_t arrayElement = 0);
+
+        ///@note All the descriptors must be set.
+        void update(const DescriptorSet& descriptor) const;
+
+    private:
+        union ResourcePtr {
+            const Buffer*     buffer;
+            const Texture*    texture;
+            const BufferView* bufferView;
+        };
+
+        // a size of 0 writes the whole buffer
+        struct BufferRange
+        {
+            uint32_t offset, size;
+        };
+
+        static DescriptorSetParams::WriteInfo writeInfo(const VkDescriptorSetLayoutBinding& binding,
+                                                        ResourcePtr resource, BufferRange range,
+                                                        uint32_t arrayElement);
+        static void                           store(ResourcePtr& ptr, const Buffer* buffer);
+        static void                           store(ResourcePtr& ptr, const Texture* texture);
+        static void                           store(ResourcePtr& ptr, const BufferView* bufferView);
+
+    private:
+        // array elements of all the bindings, in the schema order
+        std::array<ResourcePtr, kDescriptorCount> m_resources;
+        std::array<BufferRange, kDescriptorCount> m_ranges;
+    };
+
+private:
+    /// First resource index of each binding.
+    static const std::array<uint32_t, kBindingCount>& offsets();
+};
+
+template <class... Bindings>
+constexpr VkDescriptorSetLayoutBinding DescriptorSchema<Bindings...>::kLayoutBindings[kBindingCount];
+
+template <class... Bindings>
+DescriptorLayoutParam DescriptorSchema<Bindings...>::layoutParam(
+    DescriptorLayoutParam::FlagType flags /*= DescriptorLayoutParam::eNone*/)
+{
+    DescriptorLayoutParam param({DescriptorBinding(Bindings::index, Bindings::stageFlags,
+                                                   DescriptorType(Bindings::type), Bindings::count)...},
+                                flags);
+    return param;
+}
+
+template <class... Bindings>
+DescriptorSetLayout DescriptorSchema<Bindings...>::layout(
+    const DeviceContext& device, DescriptorLayoutParam::FlagType flags /*= DescriptorLayoutParam::eNone*/)
+{
+    return device.descriptorLayoutCache().get(layoutParam(flags));
+}
+
+template <class... Bindings>
+const std::array<uint32_t, DescriptorSchema<Bindings...>::kBindingCount>& DescriptorSchema<Bindings...>::offsets()
+{
+    static const std::array<uint32_t, kBindingCount> kOffsets = []() {
+        std::array<uint32_t, kBindingCount> offsets;
+        uint32_t                            offset = 0;
+        for (size_t i = 0; i < kBindingCount; ++i)
+        {
+            offsets[i] = offset;
+            offset += kLayoutBindings[i].descriptorCount;
+        }
+        return offsets;
+    }();
+    return kOffsets;
+}
+
+template <class... Bindings>
+DescriptorSchema<Bindings...>::Writes::Writes()
+{
+    ResourcePtr null;
+    null.buffer = nullptr;
+    m_resources.fill(null);
+    m_ranges.fill(BufferRange{0, 0});
+}
+
+template <class... Bindings>
+template <size_t I>
+void DescriptorSchema<Bindings...>::Writes::set(const Resource<I>* resource, uint32_t arrayElement /*= 0*/)
+{
+    static_assert(I < kBindingCount, "INVALID_BINDING");
+    assert(resource);
+    assert(arrayElement < Binding<I>::count);
+    const uint32_t index = offsets()[I] + arrayElement;
+    store(m_resources[index], resource);
+    m_ranges[index] = BufferRange{0, 0};
+}
+
+template <class... Bindings>
+template <size_t I>
+void DescriptorSchema<Bindings...>::Writes::set(const Buffer* buffer, uint32_t offset, uint32_t size,
+                                                uint32_t arrayElement /*= 0*/)
+{
+    static_assert(I < kBindingCount, "INVALID_BINDING");
+    static_assert(std::is_same<Resource<I>, Buffer>::value, "NOT_A_BUFFER_BINDING");
+    assert(buffer);
+    assert(size > 0);
+    assert(offset + size <= buffer->bytes());
+    assert(arrayElement < Binding<I>::count);
+    const uint32_t index = offsets()[I] + arrayElement;
+    store(m_resources[index], buffer);
+    m_ranges[index] = BufferRange{offset, size};
+}
+
+template <class... Bindings>
+void DescriptorSchema<Bindings...>::Writes::update(const DescriptorSet& descriptor) const
+{
+    assert(descriptor.m_handle);
+
+    // an array element per write, on the stack
+    DescriptorSet::DescriptorInfo descriptorInfos[kDescriptorCount];
+    VkWriteDescriptorSet          descriptorWriteInfos[kDescriptorCount];
+
+    size_t k = 0;
+    for (size_t i = 0; i < kBindingCount; ++i)
+    {
+        const auto& binding = kLayoutBindings[i];
+        for (uint32_t j = 0; j < binding.descriptorCount; ++j, ++k)
+        {
+            const auto info = writeInfo(binding, m_resources[k], m_ranges[k], j);
+            DescriptorSet::setInfos(info, descriptor.m_handle, descriptorInfos + k, descriptorWriteInfos[k]);
+        }
+    }
+    vkUpdateDescriptorSets(descriptor.m_device, kDescriptorCount, descriptorWriteInfos, 0, nullptr);
+}
+
+template <class... Bindings>
+DescriptorSetParams::WriteInfo DescriptorSchema<Bindings...>::Writes::writeInfo(
+    const VkDescriptorSetLayoutBinding& binding, ResourcePtr resource, BufferRange range, uint32_t arrayElement)
+{
+    const DescriptorType type = DescriptorType(binding.descriptorType);
+    switch (binding.descriptorType)
+    {
+        case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+        case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+        case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+        {
+            assert(resource.texture);
+            DescriptorSetParams::WriteInfo info(binding.binding, resource.texture,
+                                                (DescriptorSetParams::TextureType)binding.descriptorType);
+            info.arrayElement = arrayElement;
+            return info;
+        }
+        case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+        case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+        {
+            assert(resource.bufferView);
+            DescriptorSetParams::WriteInfo info(binding.binding, resource.bufferView, type);
+            info.arrayElement = arrayElement;
+            return info;
+        }
+        default:
+        {
+            assert(resource.buffer);
+            // the bind offsets are added to the range's offset, the whole buffer would overflow
+            assert(range.size || (binding.descriptorType != VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC &&
+                                  binding.descriptorType != VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC));
+            DescriptorSetParams::WriteInfo info =
+                range.size ? DescriptorSetParams::WriteInfo(binding.binding, resource.buffer, range.offset, range.size,
+                                                            type)
+                           : DescriptorSetParams::WriteInfo(binding.binding, resource.buffer, type);
+            info.arrayElement = arrayElement;
+            return info;
+        }
+    }
+}
+
+template <class... Bindings>
+inline void DescriptorSchema<Bindings...>::Writes::store(ResourcePtr& ptr, const Buffer* buffer)
+{
+    ptr.buffer = buffer;
+}
+
+template <class... Bindings>
+inline void DescriptorSchema<Bindings...>::Writes::store(ResourcePtr& ptr, const Texture* texture)
+{
+    ptr.texture = texture;
+}
+
+template <class... Bindings>
+inline void DescriptorSchema<Bindings...>::Writes::store(ResourcePtr& ptr, const BufferView* bufferView)
+{
+    ptr.bufferView = bufferView;
+}
+}  // namespace ri
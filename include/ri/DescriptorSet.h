@@ -1,6 +1,8 @@
 #pragma once
 
+#include <vector>
 #include <ri/Buffer.h>
+#include <ri/BufferView.h>
 #include <ri/CommandBuffer.h>
 #include <ri/ComputePipeline.h>
 #include <ri/RenderPipeline.h>
@@ -27,8 +29,13 @@ struct DescriptorSetParams
     struct WriteInfo
     {
         union {
-            const Buffer*  buffer;
-            const Texture* texture;
+            const Buffer*     buffer;
+            const Texture*    texture;
+            const BufferView* bufferView;
+            // contiguous array elements, see isArray
+            const Buffer* const*     buffers;
+            const Texture* const*    textures;
+            const BufferView* const* bufferViews;
         };
         struct BufferInfo
         {
@@ -46,15 +53,35 @@ struct DescriptorSetParams
 
         uint32_t       binding;
         DescriptorType type;
+        // first array element and the count of the written descriptors
+        uint32_t arrayElement = 0;
+        uint32_t count        = 1;
 
-        WriteInfo(uint32_t binding, const Buffer* buffer, uint32_t offset, uint32_t size);
+        ///@note For the dynamic buffer types size is the range seen by a draw, the bind offsets are added to offset.
+        WriteInfo(uint32_t binding, const Buffer* buffer, uint32_t offset, uint32_t size,
+                  DescriptorType type = DescriptorType::eUniformBuffer);
         WriteInfo(uint32_t binding, const Buffer* buffer, DescriptorType type);
         WriteInfo(uint32_t binding, const Texture* texture, TextureType type = eCombinedSampler);
+        ///@param type Either eTexelBuffer(storage) or eUniformTexelBuffer.
+        WriteInfo(uint32_t binding, const BufferView* bufferView, DescriptorType type = DescriptorType::eTexelBuffer);
+        /// Writes the whole buffers to the array elements starting at arrayElement.
+        WriteInfo(uint32_t binding, const Buffer* const* buffers, uint32_t count, DescriptorType type,
+                  uint32_t arrayElement = 0);
+        WriteInfo(uint32_t binding, const Texture* const* textures, uint32_t count, TextureType type = eCombinedSampler,
+                  uint32_t arrayElement = 0);
+        WriteInfo(uint32_t binding, const BufferView* const* bufferViews, uint32_t count,
+                  DescriptorType type = DescriptorType::eTexelBuffer, uint32_t arrayElement = 0);
 
         const Mode mode() const;
+        bool       isArray() const;
+
+        const Buffer*     bufferAt(uint32_t index) const;
+        const Texture*    textureAt(uint32_t index) const;
+        const BufferView* bufferViewAt(uint32_t index) const;
 
     private:
         Mode m_mode;
+        bool m_array = false;
     };
 
     DescriptorSetParams();
@@ -73,21 +100,35 @@ class DescriptorSet : public RenderObject<VkDescriptorSet>
 public:
     DescriptorSet();
 
+    ///@param InfoCount Maximum count of descriptors written, array writes count all their elements.
     template <int InfoCount>
     void update(const DescriptorSetParams& params);
+    void update(const DescriptorSetParams& params);
 
-    void bind(CommandBuffer& buffer, const RenderPipeline& pipeline) const;
-    void bind(CommandBuffer& buffer, const ComputePipeline& pipeline) const;
+    ///@param setIndex Set number in the pipeline layout, sets with other update frequencies stay bound.
+    ///@param dynamicOffsets One offset per dynamic buffer descriptor of the set, in the binding order.
+    void bind(CommandBuffer& buffer, const RenderPipeline& pipeline, uint32_t setIndex = 0,
+              const uint32_t* dynamicOffsets = nullptr, uint32_t dynamicOffsetCount = 0) const;
+    void bind(CommandBuffer& buffer, const ComputePipeline& pipeline, uint32_t setIndex = 0,
+              const uint32_t* dynamicOffsets = nullptr, uint32_t dynamicOffsetCount = 0) const;
 
     /// Batch call for setting multiple descriptors.
     ///@note Preferred over individual calls.
     template <int InfoCount, int Count>
     static void update(const DescriptorSet* (&descriptors)[Count],
                        const DescriptorSetParams (&descriptorParams)[Count]);
-    /// Batch call for binding multiple descriptors.
+    /// Batch call for setting multiple descriptors with a single update.
+    static void update(const DescriptorSet* const* descriptors, const DescriptorSetParams* descriptorParams,
+                       size_t count);
+    /// Batch call for binding multiple descriptors to consecutive sets starting at firstSet.
+    ///@param dynamicOffsets Offsets of all the sets' dynamic buffer descriptors, in the set and binding order.
     ///@note Preferred over individual calls.
     template <int Count>
-    static void bind(CommandBuffer& buffer, const RenderPipeline& pipeline, const DescriptorSet* (&descriptors)[Count]);
+    static void bind(CommandBuffer& buffer, const RenderPipeline& pipeline, const DescriptorSet* (&descriptors)[Count],
+                     uint32_t firstSet = 0, const uint32_t* dynamicOffsets = nullptr, uint32_t dynamicOffsetCount = 0);
+    template <int Count>
+    static void bind(CommandBuffer& buffer, const ComputePipeline& pipeline, const DescriptorSet* (&descriptors)[Count],
+                     uint32_t firstSet = 0, const uint32_t* dynamicOffsets = nullptr, uint32_t dynamicOffsetCount = 0);
 
 private:
     struct DescriptorInfo
@@ -95,6 +136,7 @@ private:
         union {
             VkDescriptorBufferInfo buffer;
             VkDescriptorImageInfo  image;
+            VkBufferView           texelBuffer;
         };
     };
 
@@ -105,71 +147,113 @@ private:
     {
     }
 
+    template <int Count>
+    static void bind(VkCommandBuffer buffer, VkPipelineBindPoint bindPoint, VkPipelineLayout layout,
+                     const DescriptorSet* (&descriptors)[Count], uint32_t firstSet, const uint32_t* dynamicOffsets,
+                     uint32_t dynamicOffsetCount)
+    {
+        assert(!dynamicOffsetCount || dynamicOffsets);
+
+        VkDescriptorSet handles[Count];
+        for (int i = 0; i < Count; ++i)
+        {
+            auto descriptor = descriptors[i];
+            assert(descriptor);
+            assert(descriptor->m_handle);
+            handles[i] = descriptor->m_handle;
+        }
+
+        vkCmdBindDescriptorSets(buffer, bindPoint, layout, firstSet, Count, handles, dynamicOffsetCount,
+                                dynamicOffsets);
+    }
+
+    static size_t descriptorCount(const DescriptorSetParams& params)
+    {
+        size_t count = 0;
+        for (const auto& writeInfo : params.infos)
+            count += writeInfo.count;
+        return count;
+    }
+
+    ///@param infos Must hold params.count infos.
     static void setInfos(const DescriptorSetParams::WriteInfo& params, VkDescriptorSet descriptor,  //
-                         DescriptorInfo& info, VkWriteDescriptorSet& descriptorWrite)
+                         DescriptorInfo* infos, VkWriteDescriptorSet& descriptorWrite)
     {
+        assert(params.count);
         descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
 
         switch (params.mode())
         {
             case DescriptorSetParams::eBuffer:
             {
-                auto& bufferInfo                 = info.buffer;
-                bufferInfo.buffer                = detail::getVkHandle(*params.buffer);
-                bufferInfo.offset                = params.bufferInfo.offset;
-                bufferInfo.range                 = params.bufferInfo.size;
-                descriptorWrite.pBufferInfo      = &bufferInfo;
+                for (uint32_t i = 0; i < params.count; ++i)
+                {
+                    const Buffer* buffer     = params.bufferAt(i);
+                    auto&         bufferInfo = infos[i].buffer;
+                    bufferInfo.buffer        = detail::getVkHandle(*buffer);
+                    bufferInfo.offset        = params.isArray() ? 0 : params.bufferInfo.offset;
+                    bufferInfo.range         = params.isArray() ? buffer->bytes() : params.bufferInfo.size;
+                }
+                descriptorWrite.pBufferInfo      = &infos[0].buffer;
                 descriptorWrite.pImageInfo       = nullptr;
                 descriptorWrite.pTexelBufferView = nullptr;
                 break;
             }
             case DescriptorSetParams::eTexture:
             {
-                auto&       imageInfo   = info.image;
-                const auto& textureInfo = detail::getTextureDescriptorInfo(*params.texture);
-                imageInfo.imageLayout   = textureInfo.layout;
-
-                auto imageView = textureInfo.imageView;
-                if (params.textureInfo.level != 0)
+                for (uint32_t i = 0; i < params.count; ++i)
                 {
-                    imageView = detail::createExtraImageView(*params.texture, params.textureInfo.level, 0);
+                    const Texture* texture     = params.textureAt(i);
+                    auto&          imageInfo   = infos[i].image;
+                    const auto&    textureInfo = detail::getTextureDescriptorInfo(*texture);
+                    imageInfo.imageLayout      = textureInfo.layout;
+
+                    auto imageView = textureInfo.imageView;
+                    if (params.textureInfo.level != 0)
+                    {
+                        imageView = detail::createExtraImageView(*texture, params.textureInfo.level, 0);
+                    }
+
+                    imageInfo.imageView = imageView;
+                    if (params.type == DescriptorType::eSampledImage || params.type == DescriptorType::eCombinedSampler)
+                        imageInfo.sampler = textureInfo.sampler;
+                    else
+                        imageInfo.sampler = VK_NULL_HANDLE;
                 }
-
-                imageInfo.imageView = imageView;
-                if (params.type == DescriptorType::eSampledImage || params.type == DescriptorType::eCombinedSampler)
-                    imageInfo.sampler = textureInfo.sampler;
-                else
-                    imageInfo.sampler = VK_NULL_HANDLE;
-                descriptorWrite.pImageInfo       = &imageInfo;
+                descriptorWrite.pImageInfo       = &infos[0].image;
                 descriptorWrite.pBufferInfo      = nullptr;
                 descriptorWrite.pTexelBufferView = nullptr;
                 break;
             }
             case DescriptorSetParams::eTexelBuffer:
             {
-                // TODO: add support
-                assert(false);
-                VkBufferView bufferView;
-                descriptorWrite.pTexelBufferView = &bufferView;
+                for (uint32_t i = 0; i < params.count; ++i)
+                    infos[i].texelBuffer = detail::getVkHandle(*params.bufferViewAt(i));
+                descriptorWrite.pTexelBufferView = &infos[0].texelBuffer;
                 descriptorWrite.pImageInfo       = nullptr;
                 descriptorWrite.pBufferInfo      = nullptr;
+                break;
             }
             default:
                 break;
         }
 
-        descriptorWrite.dstSet     = descriptor;
-        descriptorWrite.dstBinding = params.binding;
-        // TODO: expose array update
-        descriptorWrite.dstArrayElement = 0;
+        descriptorWrite.dstSet          = descriptor;
+        descriptorWrite.dstBinding      = params.binding;
+        descriptorWrite.dstArrayElement = params.arrayElement;
         descriptorWrite.descriptorType  = (VkDescriptorType)params.type;
-        descriptorWrite.descriptorCount = 1;
+        descriptorWrite.descriptorCount = params.count;
         descriptorWrite.pNext           = nullptr;
     }
 
     VkDevice m_device = VK_NULL_HANDLE;
 
     friend class DescriptorPool;  // DescriptorSet can be created only from a pool
+    friend class DescriptorAllocator;
+    friend class BindlessTable;
+    friend class CommandBuffer;  // for the push descriptors
+    template <class... Bindings>
+    friend class DescriptorSchema;
 };
 
 inline DescriptorSet::DescriptorSet() {}
@@ -178,45 +262,66 @@ template <int InfoCount>
 inline void DescriptorSet::update(const DescriptorSetParams& params)
 {
     assert(m_handle);
-    assert(InfoCount >= params.infos.size());
+    assert(InfoCount >= descriptorCount(params));
 
     DescriptorInfo       descriptorInfos[InfoCount];
     VkWriteDescriptorSet descriptorWriteInfos[InfoCount];
 
-    size_t i = 0;
+    size_t i = 0, j = 0;
     for (const auto& writeInfo : params.infos)
     {
-        assert(i < InfoCount);
-        setInfos(writeInfo, m_handle, descriptorInfos[i], descriptorWriteInfos[i]);
+        assert(j + writeInfo.count <= InfoCount);
+        setInfos(writeInfo, m_handle, descriptorInfos + j, descriptorWriteInfos[i]);
+        j += writeInfo.count;
         ++i;
     }
 
     vkUpdateDescriptorSets(m_device, i, descriptorWriteInfos, 0, nullptr);
 }
 
-inline void DescriptorSet::bind(CommandBuffer& buffer, const RenderPipeline& pipeline) const
+inline void DescriptorSet::update(const DescriptorSetParams& params)
+{
+    // written on the stack, only sets with more descriptors allocate
+    const int kStackInfoCount = 16;
+    if (descriptorCount(params) <= kStackInfoCount)
+    {
+        update<kStackInfoCount>(params);
+        return;
+    }
+
+    const DescriptorSet* descriptor = this;
+    update(&descriptor, &params, 1);
+}
+
+inline void DescriptorSet::bind(CommandBuffer& buffer, const RenderPipeline& pipeline, uint32_t setIndex /*= 0*/,
+                                const uint32_t* dynamicOffsets /*= nullptr*/, uint32_t dynamicOffsetCount /*= 0*/) const
 {
     assert(m_handle);
+    assert(!dynamicOffsetCount || dynamicOffsets);
     vkCmdBindDescriptorSets(detail::getVkHandle(buffer), VK_PIPELINE_BIND_POINT_GRAPHICS,
-                            detail::getPipelineLayout(pipeline), 0, 1, &m_handle, 0, nullptr);
+                            detail::getPipelineLayout(pipeline), setIndex, 1, &m_handle, dynamicOffsetCount,
+                            dynamicOffsets);
 }
 
-inline void DescriptorSet::bind(CommandBuffer& buffer, const ComputePipeline& pipeline) const
+inline void DescriptorSet::bind(CommandBuffer& buffer, const ComputePipeline& pipeline, uint32_t setIndex /*= 0*/,
+                                const uint32_t* dynamicOffsets /*= nullptr*/, uint32_t dynamicOffsetCount /*= 0*/) const
 {
     assert(m_handle);
+    assert(!dynamicOffsetCount || dynamicOffsets);
     vkCmdBindDescriptorSets(detail::getVkHandle(buffer), VK_PIPELINE_BIND_POINT_COMPUTE,
-                            detail::getPipelineLayout(pipeline), 0, 1, &m_handle, 0, nullptr);
+                            detail::getPipelineLayout(pipeline), setIndex, 1, &m_handle, dynamicOffsetCount,
+                            dynamicOffsets);
 }
 
 template <int InfoCount, int Count>
-static void DescriptorSet::update(const DescriptorSet* (&descriptors)[Count],
-                                  const DescriptorSetParams (&descriptorParams)[Count])
+void DescriptorSet::update(const DescriptorSet* (&descriptors)[Count],
+                           const DescriptorSetParams (&descriptorParams)[Count])
 {
     DescriptorInfo       descriptorInfos[InfoCount];
     VkWriteDescriptorSet descriptorWriteInfos[InfoCount];
 
     const auto device = descriptors[0]->m_device;
-    size_t     j      = 0;
+    size_t     j = 0, k = 0;
     for (int i = 0; i < Count; ++i)
     {
         auto descriptor = descriptors[i];
@@ -227,28 +332,64 @@ static void DescriptorSet::update(const DescriptorSet* (&descriptors)[Count],
         for (const auto& writeInfo : params.infos)
         {
             assert(j < InfoCount);
-            setInfos(writeInfo, descriptor->m_handle, descriptorInfos[j++], descriptorWriteInfos[j++]);
+            assert(k + writeInfo.count <= InfoCount);
+            setInfos(writeInfo, descriptor->m_handle, descriptorInfos + k, descriptorWriteInfos[j]);
+            k += writeInfo.count;
+            ++j;
         }
     }
     vkUpdateDescriptorSets(device, j, descriptorWriteInfos, 0, nullptr);
 }
 
-template <int Count>
-void DescriptorSet::bind(CommandBuffer& buffer, const RenderPipeline& pipeline,
-                         const DescriptorSet* (&descriptors)[Count])
+inline void DescriptorSet::update(const DescriptorSet* const* descriptors,
+                                  const DescriptorSetParams* descriptorParams, size_t count)
 {
-    VkDescriptorSet handles[Count];
+    assert(descriptors && descriptorParams);
 
-    for (int i = 0; i < Count; ++i)
+    size_t writeCount = 0, infoCount = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        writeCount += descriptorParams[i].infos.size();
+        infoCount += descriptorCount(descriptorParams[i]);
+    }
+
+    std::vector<DescriptorInfo>       descriptorInfos(infoCount);
+    std::vector<VkWriteDescriptorSet> descriptorWriteInfos(writeCount);
+
+    size_t j = 0, k = 0;
+    for (size_t i = 0; i < count; ++i)
     {
         auto descriptor = descriptors[i];
         assert(descriptor);
         assert(descriptor->m_handle);
-        handles[i] = descriptor->m_handle;
+
+        for (const auto& writeInfo : descriptorParams[i].infos)
+        {
+            setInfos(writeInfo, descriptor->m_handle, descriptorInfos.data() + k, descriptorWriteInfos[j]);
+            k += writeInfo.count;
+            ++j;
+        }
     }
+    if (j)
+        vkUpdateDescriptorSets(descriptors[0]->m_device, j, descriptorWriteInfos.data(), 0, nullptr);
+}
+
+template <int Count>
+void DescriptorSet::bind(CommandBuffer& buffer, const RenderPipeline& pipeline,
+                         const DescriptorSet* (&descriptors)[Count], uint32_t firstSet /*= 0*/,
+                         const uint32_t* dynamicOffsets /*= nullptr*/, uint32_t dynamicOffsetCount /*= 0*/)
+{
+    bind(detail::getVkHandle(buffer), VK_PIPELINE_BIND_POINT_GRAPHICS, detail::getPipelineLayout(pipeline),
+         descriptors, firstSet, dynamicOffsets, dynamicOffsetCount);
+}
 
-    vkCmdBindDescriptorSets(detail::getVkHandle(buffer), m_bindPoint, detail::getPipelineLayout(pipeline), 0, Count,
-                            handles, 0, nullptr);
+template <int Count>
+void DescriptorSet::bind(CommandBuffer& buffer, const ComputePipeline& pipeline,
+                         const DescriptorSet* (&descriptors)[Count], uint32_t firstSet /*= 0*/,
+                         const uint32_t* dynamicOffsets /*= nullptr*/, uint32_t dynamicOffsetCount /*= 0*/)
+{
+    bind(detail::getVkHandle(buffer), VK_PIPELINE_BIND_POINT_COMPUTE, detail::getPipelineLayout(pipeline),
+         descriptors, firstSet, dynamicOffsets, dynamicOffsetCount);
 }
 
 //
@@ -276,11 +417,12 @@ void DescriptorSetParams::add(Args&&... args)
     infos.emplace_back(std::forward<Args>(args)...);
 }
 
-inline DescriptorSetParams::WriteInfo::WriteInfo(uint32_t binding, const Buffer* buffer, uint32_t offset, uint32_t size)
+inline DescriptorSetParams::WriteInfo::WriteInfo(uint32_t binding, const Buffer* buffer, uint32_t offset, uint32_t size,
+                                                 DescriptorType type /*= DescriptorType::eUniformBuffer*/)
     : buffer(buffer)
     , binding(binding)
     , m_mode(eBuffer)
-    , type(DescriptorType::eUniformBuffer)
+    , type(type)
 {
     bufferInfo.offset = offset;
     bufferInfo.size   = size;
@@ -306,9 +448,92 @@ inline DescriptorSetParams::WriteInfo::WriteInfo(uint32_t binding, const Texture
     textureInfo.level = 0;
 }
 
+inline DescriptorSetParams::WriteInfo::WriteInfo(uint32_t binding, const BufferView* bufferView,
+                                                 DescriptorType type /*= DescriptorType::eTexelBuffer*/)
+    : bufferView(bufferView)
+    , binding(binding)
+    , m_mode(eTexelBuffer)
+    , type(type)
+{
+    assert(type == DescriptorType::eTexelBuffer || type == DescriptorType::eUniformTexelBuffer);
+    bufferInfo.offset = 0;
+    bufferInfo.size   = 0;
+}
+
+inline DescriptorSetParams::WriteInfo::WriteInfo(uint32_t binding, const Buffer* const* buffers, uint32_t count,
+                                                 DescriptorType type, uint32_t arrayElement /*= 0*/)
+    : buffers(buffers)
+    , binding(binding)
+    , type(type)
+    , arrayElement(arrayElement)
+    , count(count)
+    , m_mode(eBuffer)
+    , m_array(true)
+{
+    assert(buffers && count);
+    bufferInfo.offset = 0;
+    bufferInfo.size   = 0;
+}
+
+inline DescriptorSetParams::WriteInfo::WriteInfo(uint32_t binding, const Texture* const* textures, uint32_t count,
+                                                 TextureType type /*= eCombinedSampler*/,
+                                                 uint32_t arrayElement /*= 0*/)
+    : textures(textures)
+    , binding(binding)
+    , type(static_cast<DescriptorType>(type))
+    , arrayElement(arrayElement)
+    , count(count)
+    , m_mode(eTexture)
+    , m_array(true)
+{
+    assert(textures && count);
+    textureInfo.level = 0;
+}
+
+inline DescriptorSetParams::WriteInfo::WriteInfo(uint32_t binding, const BufferView* const* bufferViews,
+                                                 uint32_t count,
+                                                 DescriptorType type /*= DescriptorType::eTexelBuffer*/,
+                                                 uint32_t arrayElement /*= 0*/)
+    : bufferViews(bufferViews)
+    , binding(binding)
+    , type(type)
+    , arrayElement(arrayElement)
+    , count(count)
+    , m_mode(eTexelBuffer)
+    , m_array(true)
+{
+    assert(bufferViews && count);
+    assert(type == DescriptorType::eTexelBuffer || type == DescriptorType::eUniformTexelBuffer);
+    bufferInfo.offset = 0;
+    bufferInfo.size   = 0;
+}
+
 inline const DescriptorSetParams::Mode DescriptorSetParams::WriteInfo::mode() const
 {
     return m_mode;
 }
 
+inline bool DescriptorSetParams::WriteInfo::isArray() const
+{
+    return m_array;
+}
+
+inline const Buffer* DescriptorSetParams::WriteInfo::bufferAt(uint32_t index) const
+{
+    assert(index < count);
+    return m_array ? buffers[index] : buffer;
+}
+
+inline const Texture* DescriptorSetParams::WriteInfo::textureAt(uint32_t index) const
+{
+    assert(index < count);
+    return m_array ? textures[index] : texture;
+}
+
+inline const BufferView* DescriptorSetParams::WriteInfo::bufferViewAt(uint32_t index) const
+{
+    assert(index < count);
+    return m_array ? bufferViews[index] : bufferView;
+}
+
 }  // namespace ri
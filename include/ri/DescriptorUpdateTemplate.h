@@ -0,0 +1,68 @@
+#pragma once
+
+#include <vector>
+#include <util/noncopyable.h>
+#include <ri/DescriptorPool.h>
+
+namespace ri
+{
+class Buffer;
+class BufferView;
+class DescriptorSet;
+class Texture;
+
+/// Precompiled descriptor set update for a layout, avoids building the descriptor writes on every update.
+///@note Without the DeviceFeature::eDescriptorUpdateTemplate feature the updates fall back to descriptor writes.
+class DescriptorUpdateTemplate : util::noncopyable, public RenderObject<VkDescriptorUpdateTemplateKHR>
+{
+public:
+    /// Packed descriptor info, the update data holds an entry per array element in the layout param order.
+    union Entry {
+        VkDescriptorBufferInfo buffer;
+        VkDescriptorImageInfo  image;
+        VkBufferView           texelBuffer;
+
+        Entry();
+        Entry(const Buffer& buffer, size_t offset = 0, size_t size = VK_WHOLE_SIZE);
+        Entry(const Texture& texture, DescriptorType type = DescriptorType::eCombinedSampler);
+        Entry(const BufferView& bufferView);
+    };
+
+    ///@note The layout is retrieved from the device layout cache.
+    DescriptorUpdateTemplate(const DeviceContext& device, const DescriptorLayoutParam& param);
+    ~DescriptorUpdateTemplate();
+
+    DescriptorSetLayout layout() const;
+    size_t              entryCount() const;
+
+    ///@param entries Must hold entryCount entries.
+    void update(const DescriptorSet& descriptor, const Entry* entries) const;
+    template <size_t Count>
+    void update(const DescriptorSet& descriptor, const Entry (&entries)[Count]) const;
+
+private:
+    VkDevice                       m_device;
+    const detail::DeviceFunctions* m_functions;
+    DescriptorSetLayout            m_layout;
+    size_t                         m_entryCount;
+    // the fallback's entries, empty if the template was created
+    std::vector<VkDescriptorUpdateTemplateEntryKHR> m_entries;
+};
+
+inline DescriptorSetLayout DescriptorUpdateTemplate::layout() const
+{
+    return m_layout;
+}
+
+inline size_t DescriptorUpdateTemplate::entryCount() const
+{
+    return m_entryCount;
+}
+
+template <size_t Count>
+inline void DescriptorUpdateTemplate::update(const DescriptorSet& descriptor, const Entry (&entries)[Count]) const
+{
+    assert(Count == m_entryCount);
+    update(descriptor, static_cast<const Entry*>(entries));
+}
+}  // namespace ri
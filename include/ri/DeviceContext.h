@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <vector>
 #include <util/noncopyable.h>
@@ -10,6 +11,10 @@ namespace ri
 class ApplicationInstance;
 class Surface;
 class CommandPool;
+class DescriptorLayoutCache;
+class PipelineCache;
+class PipelineLayoutCache;
+class ShaderModuleCache;
 
 class DeviceContext : util::noncopyable, public RenderObject<VkDevice>
 {
@@ -23,15 +28,18 @@ public:
     DeviceContext(const ApplicationInstance& instance);
     ~DeviceContext();
 
-    void initialize(Surface&                            surface,             //
-                    const std::vector<DeviceFeature>&   requiredFeatures,    //
-                    const std::vector<DeviceOperation>& requiredOperations,  //
-                    const CommandPoolParam&             commandParam = CommandPoolParam());
+    ///@param optionalFeatures Enabled only if the selected device supports them, see featureEnabled.
+    void initialize(Surface&                            surface,                                //
+                    const std::vector<DeviceFeature>&   requiredFeatures,                       //
+                    const std::vector<DeviceOperation>& requiredOperations,                     //
+                    const CommandPoolParam&             commandParam     = CommandPoolParam(),  //
+                    const std::vector<DeviceFeature>&   optionalFeatures = {});
     /// @note Will attach the surfaces to the context.
-    void initialize(const std::vector<Surface*>&        surfaces,            //
-                    const std::vector<DeviceFeature>&   requiredFeatures,    //
-                    const std::vector<DeviceOperation>& requiredOperations,  //
-                    const CommandPoolParam&             commandParam = CommandPoolParam());
+    void initialize(const std::vector<Surface*>&        surfaces,                               //
+                    const std::vector<DeviceFeature>&   requiredFeatures,                       //
+                    const std::vector<DeviceOperation>& requiredOperations,                     //
+                    const CommandPoolParam&             commandParam     = CommandPoolParam(),  //
+                    const std::vector<DeviceFeature>&   optionalFeatures = {});
 
     /// Will return the default command pool.
     CommandPool&       commandPool();
@@ -49,6 +57,23 @@ public:
 
     const std::vector<DeviceOperation>& requiredOperations() const;
 
+    /// @return true if the feature was required or is a supported optional feature.
+    bool featureEnabled(DeviceFeature feature) const;
+
+    /// @return false if an extended dynamic state isn't enabled, e.g. the optional patch control points or the
+    /// extended dynamic state 3 states not supported by the device.
+    bool supportsDynamicState(DynamicState state) const;
+
+    /// Device wide cache of the descriptor set layouts.
+    DescriptorLayoutCache& descriptorLayoutCache() const;
+    /// Device wide cache of the pipeline layouts.
+    PipelineLayoutCache& pipelineLayoutCache() const;
+    /// Device wide cache of the shader modules.
+    ShaderModuleCache& shaderModuleCache() const;
+    /// Device wide pipeline cache, used by all the pipeline creations.
+    ///@note Load it before creating the pipelines and save it before destroying the context.
+    PipelineCache& pipelineCache() const;
+
 private:
     using SurfacePtr       = Surface*;
     using FamilyQueueIndex = int;
@@ -58,7 +83,8 @@ private:
     uint32_t         deviceScore(VkPhysicalDevice device, const std::vector<DeviceFeature>& requiredFeatures);
     OperationIndices searchQueueFamilies(const std::vector<DeviceOperation>& requiredOperations);
     void             createDevice(const std::vector<VkDeviceQueueCreateInfo>& queueCreateInfos,
-                                  const VkPhysicalDeviceFeatures& deviceFeatures, const std::vector<const char*>& deviceExtensions);
+                                  const VkPhysicalDeviceFeatures& deviceFeatures, const std::vector<const char*>& deviceExtensions,
+                                  const void* featuresChain);
     std::vector<VkDeviceQueueCreateInfo> attachSurfaces(const SurfacePtr* surfaces, size_t surfacesCount);
 
     static size_t commandPoolIndex(DeviceOperation operation, DeviceCommandHint commandHint)
@@ -81,20 +107,29 @@ private:
     std::array<CommandPool*, cPoolSize> m_commandPools;
     VkPhysicalDeviceMemoryProperties    m_memoryProperties;
     DeviceProperties                    m_deviceProperties;
+    detail::DeviceFunctions             m_functions;
+    DescriptorLayoutCache*              m_descriptorLayoutCache = nullptr;
+    PipelineCache*                      m_pipelineCache         = nullptr;
+    PipelineLayoutCache*                m_pipelineLayoutCache   = nullptr;
+    ShaderModuleCache*                  m_shaderModuleCache     = nullptr;
+    std::vector<DeviceFeature>          m_enabledFeatures;
+    std::vector<DynamicState>           m_extendedDynamicStates;
 
     friend VkPhysicalDevice detail::getDevicePhysicalHandle(const ri::DeviceContext& device);
     friend VkQueue          detail::getDeviceQueue(const ri::DeviceContext& device, int deviceOperation);
     friend uint32_t         detail::getDeviceQueueIndex(const ri::DeviceContext& device, int deviceOperation);
     friend const VkPhysicalDeviceMemoryProperties& detail::getDeviceMemoryProperties(const ri::DeviceContext& device);
+    friend const detail::DeviceFunctions&          detail::getDeviceFunctions(const ri::DeviceContext& device);
 };
 
 inline void DeviceContext::initialize(Surface&                            surface,             //
                                       const std::vector<DeviceFeature>&   requiredFeatures,    //
                                       const std::vector<DeviceOperation>& requiredOperations,  //
-                                      const CommandPoolParam&             commandParam /*= CommandPoolParam()*/)
+                                      const CommandPoolParam&             commandParam /*= CommandPoolParam()*/,
+                                      const std::vector<DeviceFeature>&   optionalFeatures /*= {}*/)
 {
     const std::vector<Surface*> data(1, &surface);
-    initialize(data, requiredFeatures, requiredOperations, commandParam);
+    initialize(data, requiredFeatures, requiredOperations, commandParam, optionalFeatures);
 }
 
 inline const DeviceProperties& DeviceContext::deviceProperties() const
@@ -118,6 +153,43 @@ inline const std::vector<DeviceOperation>& DeviceContext::requiredOperations() c
     return m_requiredOperations;
 }
 
+inline bool DeviceContext::featureEnabled(DeviceFeature feature) const
+{
+    return std::find(m_enabledFeatures.begin(), m_enabledFeatures.end(), feature) != m_enabledFeatures.end();
+}
+
+inline bool DeviceContext::supportsDynamicState(DynamicState state) const
+{
+    // the core states are always available
+    return (int)state.get() <= VK_DYNAMIC_STATE_STENCIL_REFERENCE ||
+           std::find(m_extendedDynamicStates.begin(), m_extendedDynamicStates.end(), state) !=
+               m_extendedDynamicStates.end();
+}
+
+inline DescriptorLayoutCache& DeviceContext::descriptorLayoutCache() const
+{
+    assert(m_descriptorLayoutCache);
+    return *m_descriptorLayoutCache;
+}
+
+inline PipelineLayoutCache& DeviceContext::pipelineLayoutCache() const
+{
+    assert(m_pipelineLayoutCache);
+    return *m_pipelineLayoutCache;
+}
+
+inline ShaderModuleCache& DeviceContext::shaderModuleCache() const
+{
+    assert(m_shaderModuleCache);
+    return *m_shaderModuleCache;
+}
+
+inline PipelineCache& DeviceContext::pipelineCache() const
+{
+    assert(m_pipelineCache);
+    return *m_pipelineCache;
+}
+
 inline CommandPool& DeviceContext::commandPool()
 {
     assert(m_defaultCommandPool);
@@ -161,6 +233,10 @@ namespace detail
     {
         return device.m_memoryProperties;
     }
+    inline const DeviceFunctions& getDeviceFunctions(const ri::DeviceContext& device)
+    {
+        return device.m_functions;
+    }
 }  // namespace detail
 
 }  // namespace ri
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <limits>
+#include <util/noncopyable.h>
+#include <ri/Types.h>
+
+namespace ri
+{
+class DeviceContext;
+
+/// Host side synchronization with queue submissions.
+class Fence : util::noncopyable, public RenderObject<VkFence>
+{
+public:
+    Fence(const DeviceContext& device, bool signaled = false);
+    ~Fence();
+
+    /// @param timeout in nanoseconds, by default disabled.
+    /// @return true if the fence was signaled before the timeout.
+    bool wait(uint64_t timeout = std::numeric_limits<uint64_t>::max()) const;
+    bool signaled() const;
+    /// Unsignals the fence, must be done before it's submitted again.
+    void reset();
+
+private:
+    VkDevice m_device;
+};
+
+inline Fence::~Fence()
+{
+    vkDestroyFence(m_device, m_handle, nullptr);
+}
+
+inline bool Fence::wait(uint64_t timeout /*= std::numeric_limits<uint64_t>::max()*/) const
+{
+    return vkWaitForFences(m_device, 1, &m_handle, VK_TRUE, timeout) == VK_SUCCESS;
+}
+
+inline bool Fence::signaled() const
+{
+    return vkGetFenceStatus(m_device, m_handle) == VK_SUCCESS;
+}
+
+inline void Fence::reset()
+{
+    RI_CHECK_RESULT_MSG("couldn't reset fence") = vkResetFences(m_device, 1, &m_handle);
+}
+}  // namespace ri
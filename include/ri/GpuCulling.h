@@ -0,0 +1,99 @@
+#pragma once
+
+#include <memory>
+#include <util/noncopyable.h>
+#include <ri/Buffer.h>
+#include <ri/ComputePipeline.h>
+#include <ri/DescriptorPool.h>
+#include <ri/DescriptorSet.h>
+
+namespace ri
+{
+class CommandBuffer;
+class DeviceContext;
+class ShaderModule;
+class Texture;
+
+/// Culls instances on the device against the view frustum and optionally a Hi-Z depth pyramid, the visible
+/// instances are compacted into an indirect buffer of VkDrawIndexedIndirectCommand with a draw count.
+/// Each visible instance is drawn with its instance index as the first instance, so the vertex shader can fetch
+/// its transform via gl_InstanceIndex.
+///@note The shader must be compiled from resources/shaders/culling.comp or culling_hiz.comp.
+///@note Requires the DeviceFeature::eMultiDrawIndirect and DeviceFeature::eDrawIndirectCount features.
+class GpuCulling : util::noncopyable
+{
+public:
+    /// Instance input layout, matches the shader.
+    struct Instance
+    {
+        // object space center and radius
+        float    boundingSphere[4];
+        uint32_t meshIndex;
+        uint32_t padding[3];
+    };
+
+    ///@param maxInstances Maximum instances that can be culled in a call.
+    ///@param hiZ If the shader was compiled with Hi-Z occlusion culling.
+    GpuCulling(const DeviceContext& device, const ShaderModule& shader, uint32_t maxInstances, bool hiZ = false);
+    ~GpuCulling();
+
+    ///@param instances Storage buffer of Instance.
+    ///@param transforms Storage buffer of column major object to world matrices, one per instance.
+    ///@param meshes Storage buffer of VkDrawIndexedIndirectCommand templates, indexed by Instance::meshIndex.
+    ///@param hiZ Depth pyramid with max depth reduction, required if created with Hi-Z culling.
+    void setInputs(const Buffer& instances, const Buffer& transforms, const Buffer& meshes,
+                   const Texture* hiZ = nullptr);
+
+    /// Records the culling pass, also the barriers needed for consuming the results as indirect draws.
+    ///@param viewProjection Column major view projection matrix, with a [0, 1] depth range.
+    ///@note Must be recorded outside of a render pass.
+    void cull(CommandBuffer& buffer, const float* viewProjection, uint32_t instanceCount);
+    /// Draws the visible instances, the index buffer and graphics pipeline must be already bound.
+    void draw(CommandBuffer& buffer) const;
+
+    /// Buffer of VkDrawIndexedIndirectCommand, one per visible instance.
+    const Buffer& commands() const;
+    /// Buffer with the visible instances count.
+    const Buffer& drawCount() const;
+    uint32_t      maxInstances() const;
+
+    /// Extracts the normalized frustum planes of a column major view projection matrix with a [0, 1] depth range,
+    /// the plane normals are pointing inside.
+    static void extractFrustumPlanes(const float* viewProjection, float (&planes)[6][4]);
+
+private:
+    struct View
+    {
+        float    viewProjection[16];
+        float    frustumPlanes[6][4];
+        uint32_t instanceCount;
+        uint32_t padding[3];
+    };
+
+    static const uint32_t kGroupSize = 64;
+
+    uint32_t                         m_maxInstances;
+    bool                             m_hiZ;
+    std::unique_ptr<DescriptorPool>  m_descriptorPool;
+    DescriptorSet                    m_descriptor;
+    std::unique_ptr<ComputePipeline> m_pipeline;
+    Buffer                           m_view;
+    Buffer                           m_commands;
+    Buffer                           m_drawCount;
+};
+
+inline const Buffer& GpuCulling::commands() const
+{
+    return m_commands;
+}
+
+inline const Buffer& GpuCulling::drawCount() const
+{
+    return m_drawCount;
+}
+
+inline uint32_t GpuCulling::maxInstances() const
+{
+    return m_maxInstances;
+}
+}  // namespace ri
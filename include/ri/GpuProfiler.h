@@ -0,0 +1,131 @@
+#pragma once
+
+#include <iosfwd>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <util/noncopyable.h>
+#include <ri/QueryPool.h>
+
+namespace ri
+{
+class CommandBuffer;
+class DeviceContext;
+
+/// Measures the GPU time of command ranges(zones) via timestamp queries.
+/// Results are read back frameLatency frames later without waiting, so profiling never stalls the device.
+class GpuProfiler : util::noncopyable
+{
+public:
+    struct ZoneStatistics
+    {
+        std::string name;
+        // nesting level of the zone when it was last recorded
+        uint32_t depth   = 0;
+        uint64_t samples = 0;
+        // timings in milliseconds
+        double last    = 0.0;
+        double average = 0.0;
+        double min     = 0.0;
+        double max     = 0.0;
+    };
+
+    ///@param maxZones Maximum zones that can be recorded per frame.
+    ///@param frameLatency Number of frames in flight, results of a frame are read when its queries are reused.
+    GpuProfiler(const DeviceContext& device, uint32_t maxZones = 64, uint32_t frameLatency = 3);
+    ~GpuProfiler();
+
+    /// Collects the available results of the oldest frame, then resets its queries for recording.
+    ///@note Must be recorded outside of a render pass, before any zone of the frame.
+    void beginFrame(CommandBuffer& buffer);
+
+    const std::vector<ZoneStatistics>& statistics() const;
+    /// @return nullptr if the zone was never read back.
+    const ZoneStatistics* statistics(const std::string& zoneName) const;
+    /// Frames whose results were not yet available when their queries had to be reused.
+    uint64_t droppedFrames() const;
+    void     resetStatistics();
+    /// Writes the zone statistics in CSV format.
+    void exportStatistics(std::ostream& stream) const;
+
+    /// The profiler that last began a frame.
+    static GpuProfiler* current();
+
+private:
+    struct Frame
+    {
+        // statistics index of each recorded zone
+        std::vector<uint32_t> zones;
+        std::vector<uint32_t> depths;
+    };
+
+    uint32_t beginZone(CommandBuffer& buffer, const char* name);
+    void     endZone(CommandBuffer& buffer, uint32_t zone);
+    void     collect(Frame& frame, uint32_t firstQuery);
+
+private:
+    QueryPool                                 m_queryPool;
+    uint32_t                                  m_maxZones;
+    double                                    m_timestampPeriod;
+    uint64_t                                  m_timestampMask;
+    std::vector<Frame>                        m_frames;
+    uint32_t                                  m_frameIndex    = 0;
+    uint32_t                                  m_depth         = 0;
+    uint64_t                                  m_droppedFrames = 0;
+    std::vector<uint64_t>                     m_timestamps;
+    std::vector<ZoneStatistics>               m_statistics;
+    std::unordered_map<std::string, uint32_t> m_zoneIndices;
+
+    static GpuProfiler* s_current;
+
+    friend class GpuZone;
+};
+
+/// Scoped GPU zone, writes a timestamp at construction and one at destruction.
+class GpuZone : util::noncopyable
+{
+public:
+    GpuZone(GpuProfiler& profiler, CommandBuffer& buffer, const char* name);
+    /// Uses the current profiler.
+    ///@note A profiler must have begun a frame before.
+    GpuZone(CommandBuffer& buffer, const char* name);
+    ~GpuZone();
+
+private:
+    GpuProfiler*   m_profiler;
+    CommandBuffer* m_buffer;
+    uint32_t       m_zone;
+};
+
+inline const std::vector<GpuProfiler::ZoneStatistics>& GpuProfiler::statistics() const
+{
+    return m_statistics;
+}
+
+inline uint64_t GpuProfiler::droppedFrames() const
+{
+    return m_droppedFrames;
+}
+
+inline GpuProfiler* GpuProfiler::current()
+{
+    return s_current;
+}
+
+inline GpuZone::GpuZone(GpuProfiler& profiler, CommandBuffer& buffer, const char* name)
+    : m_profiler(&profiler)
+    , m_buffer(&buffer)
+    , m_zone(profiler.beginZone(buffer, name))
+{
+}
+
+inline GpuZone::GpuZone(CommandBuffer& buffer, const char* name)
+    : GpuZone(*GpuProfiler::current(), buffer, name)
+{
+}
+
+inline GpuZone::~GpuZone()
+{
+    m_profiler->endZone(*m_buffer, m_zone);
+}
+}  // namespace ri
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <future>
+#include <memory>
+#include <util/noncopyable.h>
+#include <util/thread_pool.h>
+#include <ri/ComputePipeline.h>
+#include <ri/RenderPipeline.h>
+
+namespace ri
+{
+/// Creates pipelines asynchronously, spreading the shader compilation across worker threads.
+/// All the workers share the device's pipeline cache, which is internally synchronized.
+///@note The render passes, shader pipelines and modules must be alive until the pipelines are ready.
+class PipelineBuilder : util::noncopyable
+{
+public:
+    template <class Pipeline>
+    using Future = std::future<std::unique_ptr<Pipeline> >;
+
+    ///@param threadCount By default one per hardware thread.
+    PipelineBuilder(const DeviceContext& device, size_t threadCount = std::thread::hardware_concurrency());
+    /// Waits for all the pending pipelines.
+    ~PipelineBuilder();
+
+    Future<RenderPipeline> create(ri::RenderPass& pass, const ri::ShaderPipeline& shaderPipeline,
+                                  const RenderPipeline::CreateParams&  params,
+                                  const RenderPipeline::ViewportParam& viewportParam);
+    ///@note The pipeline takes ownership of the render pass.
+    Future<RenderPipeline> create(ri::RenderPass* pass, const ri::ShaderPipeline& shaderPipeline,
+                                  const RenderPipeline::CreateParams&  params,
+                                  const RenderPipeline::ViewportParam& viewportParam);
+    Future<ComputePipeline> create(DescriptorSetLayout descriptorLayout, const ri::ShaderModule& shaderModule,
+                                   const std::vector<ComputePipeline::PushParams>& pushConstants = {},
+                                   const std::string&                              procedureName = "main");
+
+    size_t threadCount() const;
+
+    /// @return true if the pipeline can be retrieved without blocking.
+    template <class Pipeline>
+    static bool isReady(const Future<Pipeline>& future);
+
+private:
+    const DeviceContext& m_device;
+    util::ThreadPool     m_threads;
+};
+
+inline size_t PipelineBuilder::threadCount() const
+{
+    return m_threads.threadCount();
+}
+
+template <class Pipeline>
+bool PipelineBuilder::isReady(const Future<Pipeline>& future)
+{
+    assert(future.valid());
+    return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+}  // namespace ri
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <util/noncopyable.h>
+#include <ri/Types.h>
+
+namespace ri
+{
+/// Pipeline compilation cache, persisted to disk so that warm starts skip the shader compilation.
+///@note Owned by the DeviceContext, used by all the pipelines created on the device.
+///@note The pipelines can be created concurrently, but load() merges into the cache which must then be externally
+/// synchronized: it must complete before any concurrent pipeline creation.
+class PipelineCache : util::noncopyable, public RenderObject<VkPipelineCache>
+{
+public:
+    PipelineCache(VkDevice device, const VkPhysicalDeviceProperties& properties);
+    ~PipelineCache();
+
+    /// Merges a previously saved cache into this one.
+    ///@note Not thread safe, no pipeline may be created with the cache meanwhile.
+    ///@return false if the file is missing or was saved by another driver or device, it's then ignored.
+    bool load(const std::string& filepath);
+    bool save(const std::string& filepath) const;
+
+    /// The current cache data, including the header.
+    std::vector<char> data() const;
+
+    /// Checks the header's vendor, device and UUID against the device.
+    static bool isCompatible(const void* data, size_t size, const VkPhysicalDeviceProperties& properties);
+
+private:
+    VkDevice                   m_device;
+    VkPhysicalDeviceProperties m_properties;
+};
+}  // namespace ri
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <util/noncopyable.h>
+#include <ri/Types.h>
+
+namespace ri
+{
+/// Device wide cache of pipeline layouts, pipelines with the same set layouts and push constant ranges share the
+/// same layout handle and thus don't invalidate the bound descriptor sets when switching between them.
+///@note Owned by the DeviceContext, the layouts are destroyed with the device.
+class PipelineLayoutCache : util::noncopyable
+{
+public:
+    PipelineLayoutCache(VkDevice device);
+    ~PipelineLayoutCache();
+
+    /// Returns the cached layout or creates a new one, the push constant ranges order doesn't matter.
+    ///@note Thread safe.
+    VkPipelineLayout get(const DescriptorSetLayout* setLayouts, size_t setLayoutCount,
+                         const VkPushConstantRange* pushRanges, size_t pushRangeCount);
+    VkPipelineLayout get(const std::vector<DescriptorSetLayout>& setLayouts,
+                         const std::vector<VkPushConstantRange>& pushRanges);
+
+    size_t size() const;
+
+private:
+    struct Entry
+    {
+        std::vector<DescriptorSetLayout> setLayouts;
+        std::vector<VkPushConstantRange> pushRanges;
+        VkPipelineLayout                 layout;
+    };
+
+    static size_t hashLayout(const std::vector<DescriptorSetLayout>& setLayouts,
+                             const std::vector<VkPushConstantRange>& pushRanges);
+    static bool   equal(const std::vector<VkPushConstantRange>& lhs, const std::vector<VkPushConstantRange>& rhs);
+
+private:
+    VkDevice m_device;
+    // entries with the same hash are kept in the bucket
+    std::unordered_map<size_t, std::vector<Entry>> m_layouts;
+    size_t                                         m_layoutCount = 0;
+    mutable std::mutex                             m_mutex;
+};
+
+inline VkPipelineLayout PipelineLayoutCache::get(const std::vector<DescriptorSetLayout>& setLayouts,
+                                                 const std::vector<VkPushConstantRange>& pushRanges)
+{
+    return get(setLayouts.data(), setLayouts.size(), pushRanges.data(), pushRanges.size());
+}
+
+inline size_t PipelineLayoutCache::size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_layoutCount;
+}
+}  // namespace ri
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <util/noncopyable.h>
+#include <ri/Types.h>
+
+namespace ri
+{
+class CommandBuffer;
+class DeviceContext;
+
+/// Pipeline statistics counters, only the ones enabled in the pool are written.
+struct PipelineStatistics
+{
+    uint64_t inputVertices             = 0;
+    uint64_t inputPrimitives           = 0;
+    uint64_t vertexInvocations         = 0;
+    uint64_t geometryInvocations       = 0;
+    uint64_t geometryPrimitives        = 0;
+    uint64_t clippingInvocations       = 0;
+    uint64_t clippingPrimitives        = 0;
+    uint64_t fragmentInvocations       = 0;
+    uint64_t tessControlPatches        = 0;
+    uint64_t tessEvaluationInvocations = 0;
+    uint64_t computeInvocations        = 0;
+};
+
+class QueryPool : util::noncopyable, public RenderObject<VkQueryPool>
+{
+public:
+    ///@param statisticFlags Combination of PipelineStatistic flags, only used with pipeline statistics queries.
+    ///@note Pipeline statistics queries require the DeviceFeature::ePipelineStatistics feature.
+    QueryPool(const DeviceContext& device, QueryType type, uint32_t queryCount,
+              uint32_t statisticFlags = PipelineStatistic::eGraphics);
+    ~QueryPool();
+
+    QueryType type() const;
+    uint32_t  queryCount() const;
+    /// Number of 64 bit values written per query.
+    uint32_t resultCount() const;
+
+    /// Resets a range of queries, they must be reset before being used again.
+    ///@note Must be recorded outside of a render pass.
+    void reset(CommandBuffer& buffer, uint32_t firstQuery, uint32_t queryCount);
+    void reset(CommandBuffer& buffer);
+
+    /// Begins an occlusion or pipeline statistics query.
+    ///@param precise Returns the exact samples count for occlusion queries, requires the
+    /// DeviceFeature::eOcclusionPrecise feature.
+    ///@note The query must be reset and ended in the same command buffer.
+    void begin(CommandBuffer& buffer, uint32_t query, bool precise = false);
+    void end(CommandBuffer& buffer, uint32_t query);
+
+    /// Writes the device timestamp once all previous commands have reached the given stage.
+    void writeTimestamp(CommandBuffer& buffer, uint32_t query,
+                        VkPipelineStageFlagBits stage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+
+    /// Reads the 64 bit results of a range of queries without waiting for them, data must hold
+    /// queryCount * resultCount() values.
+    /// @return false if any of the queries are not available yet, in which case the data is undefined.
+    bool results(uint32_t firstQuery, uint32_t queryCount, uint64_t* data) const;
+    /// Reads the results of a pipeline statistics query without waiting for it.
+    bool results(uint32_t query, PipelineStatistics& statistics) const;
+    /// @return true if the query result is available.
+    bool available(uint32_t query) const;
+
+private:
+    VkDevice  m_device = VK_NULL_HANDLE;
+    QueryType m_type;
+    uint32_t  m_queryCount;
+    uint32_t  m_statisticFlags;
+    uint32_t  m_resultCount;
+};
+
+/// Scoped query, begins the query at construction and ends it at destruction.
+class ScopedQuery : util::noncopyable
+{
+public:
+    ScopedQuery(QueryPool& pool, CommandBuffer& buffer, uint32_t query, bool precise = false);
+    ~ScopedQuery();
+
+private:
+    QueryPool&     m_pool;
+    CommandBuffer& m_buffer;
+    uint32_t       m_query;
+};
+
+inline QueryType QueryPool::type() const
+{
+    return m_type;
+}
+
+inline uint32_t QueryPool::queryCount() const
+{
+    return m_queryCount;
+}
+
+inline uint32_t QueryPool::resultCount() const
+{
+    return m_resultCount;
+}
+
+inline void QueryPool::reset(CommandBuffer& buffer)
+{
+    reset(buffer, 0, m_queryCount);
+}
+
+inline ScopedQuery::ScopedQuery(QueryPool& pool, CommandBuffer& buffer, uint32_t query, bool precise /*= false*/)
+    : m_pool(pool)
+    , m_buffer(buffer)
+    , m_query(query)
+{
+    m_pool.begin(m_buffer, m_query, precise);
+}
+
+inline ScopedQuery::~ScopedQuery()
+{
+    m_pool.end(m_buffer, m_query);
+}
+}  // namespace ri
@@ -8,6 +8,7 @@
 namespace ri
 {
 class CommandBuffer;
+class RenderPipelineLibrary;
 class ShaderPipeline;
 class VertexDescription;
 
@@ -88,8 +89,12 @@ public:
         std::vector<DescriptorSetLayout> descriptorLayouts;
         // The goal of derivative pipelines is that they be cheaper to create using the parent as a starting point, and
         // that it be more efficient (on either host or device) to switch/bind between children of the same parent.
+        // @note The parent pipeline must be created with allowDerivatives, the index is only used by the batch create
+        // and must refer to an earlier pipeline of the batch.
         const RenderPipeline* pipelineDerivative      = nullptr;
         int                   pipelineDerivativeIndex = -1;
+        // Enable/Disable creating derivatives from this pipeline
+        bool allowDerivatives = false;
 
         std::vector<PushParams> pushConstants;
     };
@@ -113,6 +118,50 @@ public:
 
         void setStencilReference(CommandBuffer& buffer, VkStencilFaceFlags faceMask, uint32_t reference);
 
+        // Extended dynamic states, a single pipeline covers the permutations of these states.
+        // Requires the DeviceFeature::eExtendedDynamicState feature.
+
+        void setCullMode(CommandBuffer& buffer, CullMode cullMode);
+
+        void setFrontFace(CommandBuffer& buffer, bool frontFaceCW);
+
+        ///@note The topology must be of the same class as the pipeline's topology, e.g. triangles or lines.
+        void setPrimitiveTopology(CommandBuffer& buffer, PrimitiveTopology primitiveTopology);
+
+        void setDepthTestEnable(CommandBuffer& buffer, bool enable);
+
+        void setDepthWriteEnable(CommandBuffer& buffer, bool enable);
+
+        void setDepthCompareOp(CommandBuffer& buffer, CompareOperation compareOp);
+
+        void setDepthBoundsTestEnable(CommandBuffer& buffer, bool enable);
+
+        void setStencilTestEnable(CommandBuffer& buffer, bool enable);
+
+        void setStencilOp(CommandBuffer& buffer, VkStencilFaceFlags faceMask, VkStencilOp failOp, VkStencilOp passOp,
+                          VkStencilOp depthFailOp, CompareOperation compareOp);
+
+        // Optional extended dynamic states, check DeviceContext::supportsDynamicState.
+
+        void setRasterizerDiscardEnable(CommandBuffer& buffer, bool enable);
+
+        void setDepthBiasEnable(CommandBuffer& buffer, bool enable);
+
+        void setPrimitiveRestartEnable(CommandBuffer& buffer, bool enable);
+
+        void setPatchControlPoints(CommandBuffer& buffer, uint32_t patchControlPoints);
+
+        // Requires the DeviceFeature::eExtendedDynamicState3 feature, the states are optional so check
+        // DeviceContext::supportsDynamicState, as for the patch control points.
+
+        void setPolygonMode(CommandBuffer& buffer, PolygonMode polygonMode);
+
+        void setDepthClampEnable(CommandBuffer& buffer, bool enable);
+
+        void setColorBlendEnable(CommandBuffer& buffer, bool enable, uint32_t attachment = 0);
+
+        void setColorWriteMask(CommandBuffer& buffer, VkColorComponentFlags writeMask, uint32_t attachment = 0);
+
     private:
         VkViewport m_viewport;
         VkRect2D   m_scissor;
@@ -154,6 +203,13 @@ public:
                    const ri::ShaderPipeline& shaderPipeline,  //
                    const CreateParams&       params,          //
                    const Sizei& viewportSize, int32_t viewportX = 0, int32_t viewportY = 0);
+    /// Links the pipeline from libraries, together they must contain all the library parts.
+    ///@param optimize Link time optimization, links slower but the pipeline may run faster.
+    ///@note Requires the graphics pipeline library feature.
+    RenderPipeline(const ri::DeviceContext&                         device,     //
+                   ri::RenderPass&                                  pass,       //
+                   const std::vector<const RenderPipelineLibrary*>& libraries,  //
+                   bool                                             optimize = false);
     ~RenderPipeline();
 
     ri::RenderPass&       defaultPass();
@@ -230,7 +286,8 @@ private:
     {
     }
 
-    static VkPipelineLayout createLayout(const VkDevice device, const CreateParams& params,
+    /// Returns the shared layout from the device's pipeline layout cache.
+    static VkPipelineLayout createLayout(const ri::DeviceContext& device, const CreateParams& params,
                                          const std::vector<VkDescriptorSetLayout>& descriptorLayouts);
 
     static VkViewport                             getViewportFrom(const RenderPipeline::ViewportParam& viewportParam);
@@ -264,6 +321,7 @@ private:
     DynamicState     m_dynamicState;
 
     friend VkPipelineLayout detail::getPipelineLayout(const RenderPipeline& pipeline);
+    friend class RenderPipelineLibrary;
 };
 
 inline void RenderPipeline::begin(const CommandBuffer& buffer, const RenderTarget& target) const
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <util/noncopyable.h>
+#include <ri/PipelineBuilder.h>
+#include <ri/RenderPipeline.h>
+
+namespace ri
+{
+/// Deduplicates render pipelines, identical states share the same pipeline and creation only happens on a miss.
+/// The state is the create params, the render pass's compatible state (attachment formats and samples, subpasses),
+/// the shader stages and the viewport unless it's dynamic.
+/// With a pipeline builder, misses of request() are compiled in the background and a fallback pipeline is returned
+/// meanwhile, so a new permutation never stalls the frame.
+///@note The render passes and shader pipelines must outlive the cache, as the key only stores their handles.
+class RenderPipelineCache : util::noncopyable
+{
+public:
+    struct Statistics
+    {
+        uint64_t hits   = 0;
+        uint64_t misses = 0;
+        // requests answered with the fallback pipeline, or skipped when there's none
+        uint64_t fallbacks = 0;
+        uint64_t skipped   = 0;
+        // timings in milliseconds
+        // time spent blocked on the creation of pipelines
+        double stallTime = 0.0;
+        double maxStall  = 0.0;
+        // time between the background compile request and the first use of the pipeline
+        double maxPendingTime = 0.0;
+    };
+
+    ///@param builder If set, enables the background compilation of request(), it must outlive the cache.
+    RenderPipelineCache(const DeviceContext& device, PipelineBuilder* builder = nullptr);
+    /// Waits for the pending pipelines.
+    ~RenderPipelineCache();
+
+    /// Returns the cached pipeline or creates a new one, waits if the pipeline is being compiled in the background.
+    /// If the creation throws the exception is propagated and the state isn't cached, a failed background compilation
+    /// is created again synchronously.
+    ///@note Thread safe, the creation and the wait don't hold the cache's lock so request() isn't blocked.
+    /// Pipelines are shared between compatible render passes, the default pass of a pipeline is the one it was created
+    /// with.
+    RenderPipeline& get(RenderPass& pass, const ShaderPipeline& shaderPipeline,
+                        const RenderPipeline::CreateParams&  params,
+                        const RenderPipeline::ViewportParam& viewportParam);
+    /// Returns the cached pipeline without blocking, a miss is compiled in the background and the fallback pipeline is
+    /// returned until it's ready.
+    ///@note Without a builder the pipeline is created synchronously.
+    ///@return nullptr if the pipeline isn't ready and there is no fallback, the draw should then be skipped.
+    RenderPipeline* request(RenderPass& pass, const ShaderPipeline& shaderPipeline,
+                            const RenderPipeline::CreateParams&  params,
+                            const RenderPipeline::ViewportParam& viewportParam);
+
+    /// Used by request() while the pipelines are compiled, must be compatible with the render pass of the draws.
+    void            setFallback(RenderPipeline* fallback);
+    RenderPipeline* fallback() const;
+
+    /// Count of cached pipelines, including the ones being compiled.
+    size_t size() const;
+    /// Count of pipelines being compiled in the background.
+    size_t pendingCount() const;
+    /// Waits for all the pipelines being compiled or created, the failed ones are dropped.
+    void finish();
+    /// Destroys all the cached pipelines.
+    ///@note Must not be called concurrently with get().
+    void clear();
+
+    Statistics statistics() const;
+    void       resetStatistics();
+
+    static size_t hash(const RenderPass& pass, const ShaderPipeline& shaderPipeline,
+                       const RenderPipeline::CreateParams&  params,
+                       const RenderPipeline::ViewportParam& viewportParam);
+
+private:
+    // the whole state packed as words, compared on hash collisions
+    using Key = std::vector<uint32_t>;
+
+    using Clock = std::chrono::steady_clock;
+
+    // without a pipeline the entry is either compiled in the background or being created by another thread
+    struct Entry
+    {
+        Key                             key;
+        size_t                          seed;
+        std::unique_ptr<RenderPipeline> pipeline;
+        // valid while the pipeline is compiled in the background and no thread waits for it
+        PipelineBuilder::Future<RenderPipeline> pending;
+        Clock::time_point                       requestTime;
+        // the creation threw, the entry was removed from the cache
+        bool failed = false;
+    };
+    using EntryPtr = std::shared_ptr<Entry>;
+
+    EntryPtr find(const Key& key, size_t seed);
+    EntryPtr insert(Key&& key, size_t seed);
+    /// Waits for the entry's pipeline, the lock is released meanwhile.
+    ///@return false if the creation failed.
+    bool wait(Entry& entry, std::unique_lock<std::mutex>& lock);
+    /// Sets the pipeline of a finished background compilation.
+    ///@return false if the compilation failed, the entry is then discarded.
+    bool resolve(Entry& entry, PipelineBuilder::Future<RenderPipeline>& pending);
+    /// Removes an entry whose creation failed and wakes its waiters.
+    void discard(Entry& entry);
+    void addStall(Clock::time_point start);
+
+    static Key    makeKey(const RenderPass& pass, const ShaderPipeline& shaderPipeline,
+                          const RenderPipeline::CreateParams&  params,
+                          const RenderPipeline::ViewportParam& viewportParam);
+    static size_t hashKey(const Key& key);
+
+private:
+    const DeviceContext& m_device;
+    PipelineBuilder*     m_builder;
+    RenderPipeline*      m_fallback = nullptr;
+    // entries with the same hash are kept in the bucket, shared so they stay valid while waited without the lock
+    std::unordered_map<size_t, std::vector<EntryPtr>> m_pipelines;
+    size_t                                            m_pipelineCount = 0;
+    size_t                                            m_pendingCount  = 0;
+    Statistics                                        m_statistics;
+    mutable std::mutex                                m_mutex;
+    // signaled when the pipeline of an entry is set or its creation failed
+    std::condition_variable m_ready;
+};
+
+inline void RenderPipelineCache::setFallback(RenderPipeline* fallback)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_fallback = fallback;
+}
+
+inline RenderPipeline* RenderPipelineCache::fallback() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_fallback;
+}
+
+inline size_t RenderPipelineCache::size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pipelineCount;
+}
+
+inline size_t RenderPipelineCache::pendingCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pendingCount;
+}
+
+inline RenderPipelineCache::Statistics RenderPipelineCache::statistics() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_statistics;
+}
+
+inline void RenderPipelineCache::resetStatistics()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_statistics = Statistics();
+}
+}  // namespace ri
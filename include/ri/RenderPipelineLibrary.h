@@ -0,0 +1,53 @@
+#pragma once
+
+#include <util/noncopyable.h>
+#include <ri/RenderPipeline.h>
+
+namespace ri
+{
+/// Part of a render pipeline compiled separately, the parts are linked into a render pipeline.
+/// Permutations only recompile the parts that change, e.g. the same vertex input and fragment output libraries are
+/// linked with many shaders.
+///@note Requires the graphics pipeline library feature.
+class RenderPipelineLibrary : util::noncopyable, public RenderObject<VkPipeline>
+{
+public:
+    enum PartFlags
+    {
+        // vertex input and input assembly
+        eVertexInput = VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT,
+        // vertex/tesselation/geometry shaders, viewport and rasterization
+        ePreRasterization = VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT,
+        // fragment shader and depth stencil
+        eFragmentShader = VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT,
+        // color blending and multisampling
+        eFragmentOutput = VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT,
+        eAll            = eVertexInput | ePreRasterization | eFragmentShader | eFragmentOutput
+    };
+
+    ///@param parts Combination of part flags, only the stages and params of these parts are used.
+    RenderPipelineLibrary(const ri::DeviceContext&             device,          //
+                          const ri::RenderPass&                pass,            //
+                          const ri::ShaderPipeline&            shaderPipeline,  //
+                          const RenderPipeline::CreateParams&  params,          //
+                          int                                  parts,           //
+                          const RenderPipeline::ViewportParam& viewportParam);
+    ~RenderPipelineLibrary();
+
+    int parts() const;
+
+private:
+    VkDevice         m_device         = VK_NULL_HANDLE;
+    VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
+    int              m_parts;
+    VkViewport       m_viewport;
+    VkRect2D         m_scissor;
+
+    friend class RenderPipeline;
+};
+
+inline int RenderPipelineLibrary::parts() const
+{
+    return m_parts;
+}
+}  // namespace ri
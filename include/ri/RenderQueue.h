@@ -0,0 +1,127 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <util/noncopyable.h>
+#include <ri/Types.h>
+
+namespace ri
+{
+class CommandBuffer;
+class CommandRecorder;
+class DescriptorSet;
+class IndexedVertexDescription;
+class RenderPipeline;
+class VertexDescription;
+
+/// Collects draw packets with a sort key, sorts them and replays them into a command buffer.
+/// Packets with the same pipeline and material are kept together, so the state changes are minimized.
+class RenderQueue : util::noncopyable
+{
+public:
+    static const size_t kMaxDescriptorSets = 4;
+
+    struct DrawPacket
+    {
+        const RenderPipeline* pipeline = nullptr;
+        // bound at their array index, the array is terminated by the first null set
+        std::array<const DescriptorSet*, kMaxDescriptorSets> descriptorSets;
+        // single dynamic offset of each set flagged in the mask, e.g. per draw uniforms suballocated from one buffer
+        std::array<uint32_t, kMaxDescriptorSets> dynamicOffsets;
+        uint32_t                                 dynamicOffsetMask = 0;
+        // one of the vertex descriptions must be set, indexed draws are used with an indexed description
+        const VertexDescription*        vertexDescription        = nullptr;
+        const IndexedVertexDescription* indexedVertexDescription = nullptr;
+
+        // index count for indexed draws, otherwise vertex count
+        uint32_t count         = 0;
+        uint32_t first         = 0;
+        int32_t  vertexOffset  = 0;
+        uint32_t instanceCount = 1;
+        uint32_t firstInstance = 0;
+
+        // push constants payload, copied at submit
+        ShaderStage pushStages = ShaderStage::eVertex;
+        uint32_t    pushOffset = 0;
+        uint32_t    pushSize   = 0;
+
+        DrawPacket();
+    };
+
+    /// Sort key layout, from the most significant bits: pass(8), pipeline(16), material(16), depth(24).
+    struct SortKey
+    {
+        ///@param depth Normalized depth in the [0, 1] range, sorted front to back.
+        ///@param backToFront Inverts the depth order, e.g. for transparent geometry.
+        static uint64_t make(uint8_t pass, uint16_t pipeline, uint16_t material, float depth,
+                             bool backToFront = false);
+    };
+
+    RenderQueue();
+
+    ///@param pushData Push constants payload of packet.pushSize bytes.
+    void submit(uint64_t key, const DrawPacket& packet, const void* pushData = nullptr);
+    /// Radix sorts the submitted packets by their keys, the submit order is kept for equal keys.
+    void sort();
+    /// Replays the packets in the sorted order, redundant binds are skipped.
+    void replay(CommandBuffer& buffer) const;
+    void replay(CommandRecorder& recorder) const;
+    /// Removes the packets, the allocated memory is kept.
+    void clear();
+
+    size_t size() const;
+    bool   empty() const;
+
+private:
+    struct Entry
+    {
+        uint64_t key;
+        uint32_t packetIndex;
+    };
+
+    static void radixSort(std::vector<Entry>& entries, std::vector<Entry>& scratch);
+
+private:
+    std::vector<DrawPacket> m_packets;
+    // offset of each packet payload
+    std::vector<uint32_t> m_pushDataOffsets;
+    std::vector<uint8_t>  m_pushData;
+    std::vector<Entry>    m_entries;
+    std::vector<Entry>    m_scratch;
+    bool                  m_sorted;
+};
+
+inline RenderQueue::DrawPacket::DrawPacket()
+{
+    descriptorSets.fill(nullptr);
+    dynamicOffsets.fill(0);
+}
+
+inline uint64_t RenderQueue::SortKey::make(uint8_t pass, uint16_t pipeline, uint16_t material, float depth,
+                                           bool backToFront /*= false*/)
+{
+    const uint32_t kDepthMax = (1u << 24) - 1;
+
+    depth              = depth < 0.f ? 0.f : (depth > 1.f ? 1.f : depth);
+    uint32_t depthBits = static_cast<uint32_t>(depth * kDepthMax);
+    if (backToFront)
+        depthBits = kDepthMax - depthBits;
+
+    return (uint64_t(pass) << 56) | (uint64_t(pipeline) << 40) | (uint64_t(material) << 24) | depthBits;
+}
+
+inline RenderQueue::RenderQueue()
+    : m_sorted(true)
+{
+}
+
+inline size_t RenderQueue::size() const
+{
+    return m_packets.size();
+}
+
+inline bool RenderQueue::empty() const
+{
+    return m_packets.empty();
+}
+}  // namespace ri
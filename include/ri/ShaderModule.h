@@ -1,6 +1,7 @@
 #pragma once
 
 #include <util/noncopyable.h>
+#include <ri/ShaderReflection.h>
 #include <ri/Types.h>
 
 namespace ri
@@ -10,25 +11,40 @@ class DeviceContext;
 class ShaderModule : util::noncopyable, public RenderObject<VkShaderModule>
 {
 public:
+    /// Loads the filename with the '.spv' extension, see ShaderModuleCache to share the modules.
     ShaderModule(const DeviceContext& device, const std::string& filename, ShaderStage stage);
+    ///@param code The SPIR-V code, must be 4 bytes aligned.
+    ShaderModule(const DeviceContext& device, const uint32_t* code, size_t codeSize, ShaderStage stage);
     ~ShaderModule();
 
     ShaderStage stage() const;
 
-#ifndef NDEBUG
+    /// @return true if the module has an entry point with the name.
     bool hasProcedure(const std::string& name) const;
-#endif
+    /// The module's interface, e.g. for generating its descriptor layouts and vertex inputs.
+    const ShaderReflection& reflection() const;
 
 private:
-    VkDevice    m_device = VK_NULL_HANDLE;
-    ShaderStage m_stage;
-#ifndef NDEBUG
-    std::vector<char> m_code;
-#endif  // !NDEBUG
+    void create(const uint32_t* code, size_t codeSize);
+
+private:
+    VkDevice         m_device = VK_NULL_HANDLE;
+    ShaderStage      m_stage;
+    ShaderReflection m_reflection;
 };
 
 inline ShaderStage ShaderModule::stage() const
 {
     return m_stage;
 }
+
+inline bool ShaderModule::hasProcedure(const std::string& name) const
+{
+    return m_reflection.entryPoint(name) != nullptr;
+}
+
+inline const ShaderReflection& ShaderModule::reflection() const
+{
+    return m_reflection;
+}
 }  // namespace ri
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <util/noncopyable.h>
+#include <ri/Types.h>
+
+namespace ri
+{
+class DeviceContext;
+class ShaderModule;
+
+/// Device wide cache of the shader modules, each module is loaded once and shared by the pipelines using it.
+/// The key is the path and the hash of the content, so a modified file is loaded as a new module.
+///@note Owned by the DeviceContext, the modules must be released before the device is destroyed.
+class ShaderModuleCache : util::noncopyable
+{
+public:
+    typedef std::shared_ptr<const ShaderModule> SharedModule;
+
+    ShaderModuleCache(const DeviceContext& device);
+    ~ShaderModuleCache();
+
+    /// Returns the cached module or creates a new one, the file is memory mapped to hash its content.
+    ///@param filename Path without the '.spv' extension, as for the ShaderModule.
+    ///@note Thread safe, the module is created outside of the lock so concurrent misses don't serialize.
+    ///@return nullptr if the file couldn't be read.
+    SharedModule get(const std::string& filename, ShaderStage stage);
+
+    /// Count of cached modules.
+    size_t size() const;
+    /// Destroys the modules only referenced by the cache, e.g. the previous versions of reloaded files.
+    ///@return The count of released modules.
+    size_t releaseUnused();
+    void   clear();
+
+private:
+    struct Entry
+    {
+        uint64_t     hash;
+        ShaderStage  stage;
+        SharedModule module;
+    };
+
+    ///@note The mutex must be locked.
+    SharedModule    find(const std::string& filename, uint64_t hash, ShaderStage stage) const;
+    static uint64_t hashCode(const void* data, size_t size);
+
+private:
+    const DeviceContext& m_device;
+    // the entries of a path are its versions and stages
+    std::unordered_map<std::string, std::vector<Entry>> m_modules;
+    size_t                                              m_moduleCount = 0;
+    mutable std::mutex                                  m_mutex;
+};
+
+inline size_t ShaderModuleCache::size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_moduleCount;
+}
+}  // namespace ri
@@ -1,9 +1,11 @@
 #pragma once
 
 #include <array>
+#include <memory>
 #include <util/iterator.h>
 #include <util/noncopyable.h>
 #include <ri/ShaderModule.h>
+#include <ri/SpecializationConstants.h>
 
 namespace ri
 {
@@ -14,16 +16,26 @@ public:
     ~ShaderPipeline();
 
     ///@note Takes ownerwship of the shader module.
-    void addStage(const ShaderModule* shader, const std::string& procedure = "main");
-    void addStage(const ShaderModule& shader, const std::string& procedure = "main");
+    void addStage(const ShaderModule* shader, const std::string& procedure = "main",
+                  const SpecializationConstants& constants = SpecializationConstants());
+    ///@note Shares the ownership of the shader module, e.g. from the ShaderModuleCache.
+    void addStage(const std::shared_ptr<const ShaderModule>& shader, const std::string& procedure = "main",
+                  const SpecializationConstants& constants = SpecializationConstants());
+    void addStage(const ShaderModule& shader, const std::string& procedure = "main",
+                  const SpecializationConstants& constants = SpecializationConstants());
     void removeStage(ShaderStage stage);
 
 private:
-    using ShaderModules = std::array<const ShaderModule*, (size_t)ShaderStage::Count>;
+    using ShaderModules       = std::array<const ShaderModule*, (size_t)ShaderStage::Count>;
+    using SharedShaderModules = std::array<std::shared_ptr<const ShaderModule>, (size_t)ShaderStage::Count>;
 
     ShaderModules                                       m_shaders;
+    SharedShaderModules                                 m_sharedShaders;
     std::vector<VkPipelineShaderStageCreateInfo>        m_stageInfos;
     std::array<std::string, (size_t)ShaderStage::Count> m_stageProcedures;
+    // specialization per stage info, the infos point to the constants storage
+    std::array<SpecializationConstants, (size_t)ShaderStage::Count> m_stageConstants;
+    std::array<VkSpecializationInfo, (size_t)ShaderStage::Count>    m_stageSpecializations;
 
     friend const std::vector<VkPipelineShaderStageCreateInfo>& detail::getStageCreateInfos(
         const ShaderPipeline& pipeline);
@@ -57,17 +69,33 @@ inline ShaderPipeline::~ShaderPipeline()
         delete shader;
 }
 
-inline void ShaderPipeline::addStage(const ShaderModule* shader, const std::string& procedure /*= "main"*/)
+inline void ShaderPipeline::addStage(const ShaderModule* shader, const std::string& procedure /*= "main"*/,
+                                     const SpecializationConstants& constants /*= SpecializationConstants()*/)
 {
     auto& currentShader = m_shaders[shader->stage().ordinal()];
     if (currentShader)
         delete currentShader;
 
     currentShader = shader;
-    addStage(*shader, procedure);
+    m_sharedShaders[shader->stage().ordinal()].reset();
+    addStage(*shader, procedure, constants);
 }
 
-inline void ShaderPipeline::addStage(const ShaderModule& shader, const std::string& procedure /*= "main"*/)
+inline void ShaderPipeline::addStage(const std::shared_ptr<const ShaderModule>& shader,
+                                     const std::string&                         procedure /*= "main"*/,
+                                     const SpecializationConstants& constants /*= SpecializationConstants()*/)
+{
+    assert(shader);
+    auto& currentShader = m_shaders[shader->stage().ordinal()];
+    delete currentShader;
+    currentShader = nullptr;
+
+    m_sharedShaders[shader->stage().ordinal()] = shader;
+    addStage(*shader, procedure, constants);
+}
+
+inline void ShaderPipeline::addStage(const ShaderModule& shader, const std::string& procedure /*= "main"*/,
+                                     const SpecializationConstants& constants /*= SpecializationConstants()*/)
 {
     assert(std::find_if(m_stageInfos.begin(), m_stageInfos.end(), [&shader](const auto& info) {
                return info.stage == (VkShaderStageFlagBits)shader.stage();
@@ -82,6 +110,13 @@ inline void ShaderPipeline::addStage(const ShaderModule& shader, const std::stri
     assert(m_stageInfos.size() < m_stageProcedures.size());
     auto& name = m_stageProcedures[m_stageInfos.size()] = procedure;
     stageCreateInfo.pName                               = name.c_str();
+    if (!constants.empty())
+    {
+        auto& specialization = m_stageSpecializations[m_stageInfos.size()];
+        m_stageConstants[m_stageInfos.size()] = constants;
+        specialization                        = m_stageConstants[m_stageInfos.size()].info();
+        stageCreateInfo.pSpecializationInfo   = &specialization;
+    }
 
     m_stageInfos.push_back(stageCreateInfo);
 }
@@ -98,9 +133,18 @@ inline void ShaderPipeline::removeStage(ShaderStage stage)
     m_stageInfos.erase(found);
 
     std::move(m_stageProcedures.begin() + from + 1, m_stageProcedures.begin() + end, m_stageProcedures.begin() + from);
-    // update address of the procedure name
+    std::move(m_stageConstants.begin() + from + 1, m_stageConstants.begin() + end, m_stageConstants.begin() + from);
+    m_stageConstants[end - 1] = SpecializationConstants();
+    // update address of the procedure name and specialization
     size_t i = from;
-    std::for_each(m_stageInfos.begin() + from, m_stageInfos.end(),
-                  [&i, this](auto& info) { info.pName = m_stageProcedures[i++].c_str(); });
+    std::for_each(m_stageInfos.begin() + from, m_stageInfos.end(), [&i, this](auto& info) {
+        info.pName = m_stageProcedures[i].c_str();
+        if (info.pSpecializationInfo)
+        {
+            m_stageSpecializations[i] = m_stageConstants[i].info();
+            info.pSpecializationInfo  = &m_stageSpecializations[i];
+        }
+        ++i;
+    });
 }
 }  // namespace ri
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <ri/ComputePipeline.h>
+#include <ri/DescriptorPool.h>
+#include <ri/RenderPipeline.h>
+#include <ri/VertexDescription.h>
+
+namespace ri
+{
+/**
+ * @brief Reflection of a SPIR-V module, the layouts and vertex inputs are generated from the shader's interface.
+ *
+ * @example ri::ShaderReflection reflection(code, wordCount);
+ * ri::DescriptorLayoutParam layoutParam = reflection.descriptorLayouts()[0];
+ * ri::VertexBinding         binding     = reflection.vertexBinding("main");
+ *
+ * @note The descriptors are reflected as the non dynamic types, runtime sized arrays have a count of 0 and must be set
+ * by the caller.
+ **/
+class ShaderReflection
+{
+public:
+    struct EntryPoint
+    {
+        std::string name;
+        ShaderStage stage;
+        // workgroup size of compute shaders
+        uint32_t localSize[3] = {1, 1, 1};
+        // specialization constant id of each workgroup dimension, -1 if it's not specialized
+        int localSizeSpecId[3] = {-1, -1, -1};
+        // vertex shader inputs sorted by location, packed in location order
+        std::vector<VertexInput> inputs;
+        uint32_t                 inputStride = 0;
+    };
+
+    struct Binding
+    {
+        std::string    name;
+        uint32_t       set;
+        uint32_t       binding;
+        DescriptorType type;
+        uint32_t       count;
+    };
+
+    ShaderReflection() {}
+    ///@param code The SPIR-V words.
+    ShaderReflection(const uint32_t* code, size_t wordCount, ShaderStage stage);
+
+    /// @return false if the code isn't a SPIR-V module.
+    bool valid() const;
+
+    const std::vector<EntryPoint>& entryPoints() const;
+    /// @return nullptr if the module has no such entry point.
+    const EntryPoint* entryPoint(const std::string& name) const;
+    const std::vector<Binding>& bindings() const;
+
+    /// Descriptor layouts indexed by set, the bindings are visible to the module's stage.
+    std::vector<DescriptorLayoutParam> descriptorLayouts() const;
+    /// Push constants range of the module, the size is 0 if there are none.
+    ComputePipeline::PushParams              pushConstants() const;
+    RenderPipeline::CreateParams::PushParams stagePushConstants() const;
+    /// Interleaved vertex binding of the entry point's inputs, the buffer and instancing must be set by the caller.
+    VertexBinding vertexBinding(const std::string& entryPoint = "main", uint32_t bindingIndex = 0) const;
+
+    /// Merges the descriptor layouts of several stages, the stage flags of the shared bindings are combined.
+    static std::vector<DescriptorLayoutParam> descriptorLayouts(const std::vector<const ShaderReflection*>& stages);
+    /// Merges the push constants ranges of several stages.
+    static std::vector<RenderPipeline::CreateParams::PushParams> pushConstants(
+        const std::vector<const ShaderReflection*>& stages);
+
+private:
+    ShaderStage             m_stage;
+    bool                    m_valid = false;
+    std::vector<EntryPoint> m_entryPoints;
+    std::vector<Binding>    m_bindings;
+    uint32_t                m_pushOffset = 0;
+    uint32_t                m_pushSize   = 0;
+};
+
+inline bool ShaderReflection::valid() const
+{
+    return m_valid;
+}
+
+inline const std::vector<ShaderReflection::EntryPoint>& ShaderReflection::entryPoints() const
+{
+    return m_entryPoints;
+}
+
+inline const std::vector<ShaderReflection::Binding>& ShaderReflection::bindings() const
+{
+    return m_bindings;
+}
+
+inline ComputePipeline::PushParams ShaderReflection::pushConstants() const
+{
+    return ComputePipeline::PushParams(m_pushOffset, m_pushSize);
+}
+
+inline RenderPipeline::CreateParams::PushParams ShaderReflection::stagePushConstants() const
+{
+    return RenderPipeline::CreateParams::PushParams(m_stage, m_pushOffset, m_pushSize);
+}
+}  // namespace ri
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+#include <ri/Types.h>
+
+namespace ri
+{
+/**
+ * @brief Typed values of a shader stage's specialization constants, compiled as constants with the pipeline.
+ *
+ * @example ri::SpecializationConstants constants;
+ * constants.set(0, 16u).set(1, 16u).set(2, true);
+ * // matches: layout(local_size_x_id = 0, local_size_y_id = 1) in; layout(constant_id = 2) const bool kToggle = false;
+ **/
+class SpecializationConstants
+{
+public:
+    SpecializationConstants() {}
+
+    /// Sets or overwrites the value of the constant_id, bools are stored as VkBool32.
+    template <typename T>
+    SpecializationConstants& set(uint32_t constantId, const T& value);
+    SpecializationConstants& set(uint32_t constantId, bool value);
+
+    bool   empty() const;
+    size_t size() const;
+    /// @note Points to the internal storage, valid until the constants are modified or destroyed.
+    VkSpecializationInfo info() const;
+
+    const std::vector<VkSpecializationMapEntry>& entries() const;
+    const std::vector<uint8_t>&                  data() const;
+
+private:
+    void setData(uint32_t constantId, const void* value, size_t valueSize);
+
+private:
+    std::vector<VkSpecializationMapEntry> m_entries;
+    std::vector<uint8_t>                  m_data;
+};
+
+template <typename T>
+SpecializationConstants& SpecializationConstants::set(uint32_t constantId, const T& value)
+{
+    static_assert(std::is_arithmetic<T>::value, "INVALID_CONSTANT_TYPE");
+    static_assert(sizeof(T) == 4 || sizeof(T) == 8, "INVALID_CONSTANT_SIZE");
+
+    setData(constantId, &value, sizeof(T));
+    return *this;
+}
+
+inline SpecializationConstants& SpecializationConstants::set(uint32_t constantId, bool value)
+{
+    const VkBool32 boolValue = value ? VK_TRUE : VK_FALSE;
+    setData(constantId, &boolValue, sizeof(boolValue));
+    return *this;
+}
+
+inline bool SpecializationConstants::empty() const
+{
+    return m_entries.empty();
+}
+
+inline size_t SpecializationConstants::size() const
+{
+    return m_entries.size();
+}
+
+inline VkSpecializationInfo SpecializationConstants::info() const
+{
+    VkSpecializationInfo info;
+    info.mapEntryCount = m_entries.size();
+    info.pMapEntries   = m_entries.data();
+    info.dataSize      = m_data.size();
+    info.pData         = m_data.data();
+    return info;
+}
+
+inline const std::vector<VkSpecializationMapEntry>& SpecializationConstants::entries() const
+{
+    return m_entries;
+}
+
+inline const std::vector<uint8_t>& SpecializationConstants::data() const
+{
+    return m_data;
+}
+
+inline void SpecializationConstants::setData(uint32_t constantId, const void* value, size_t valueSize)
+{
+    auto found = std::find_if(m_entries.begin(), m_entries.end(), [constantId](const VkSpecializationMapEntry& entry) {
+        return entry.constantID == constantId;
+    });
+    if (found != m_entries.end())
+    {
+        assert(found->size == valueSize);
+        std::memcpy(m_data.data() + found->offset, value, valueSize);
+        return;
+    }
+
+    VkSpecializationMapEntry entry;
+    entry.constantID = constantId;
+    entry.offset     = (uint32_t)m_data.size();
+    entry.size       = valueSize;
+    m_entries.push_back(entry);
+
+    m_data.resize(m_data.size() + valueSize);
+    std::memcpy(m_data.data() + entry.offset, value, valueSize);
+}
+}  // namespace ri
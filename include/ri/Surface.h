@@ -9,6 +9,7 @@ namespace ri
 class ApplicationInstance;
 class DeviceContext;
 class CommandBuffer;
+class Fence;
 class RenderTarget;
 class RenderPass;
 struct RenderPassAttachment;
@@ -45,8 +46,9 @@ public:
     // @return active/available index of the swapchain.
     uint32_t acquire(uint64_t timeout = std::numeric_limits<uint64_t>::max());
     // @warning Must always be called in pair with acquire.
+    // @param fence Reset and signaled when the submitted commands complete, optional.
     // @return true if the presentation was successful.
-    bool present(const ri::DeviceContext& device);
+    bool present(const ri::DeviceContext& device, Fence* fence = nullptr);
     // Wait for the presentation to finish synchronously
     void waitIdle();
 
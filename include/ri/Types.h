@@ -14,7 +14,22 @@ SAFE_ENUM_DECLARE(DeviceFeature,
                   eSwapchain,
                   eAnisotropy,
                   eSampleRateShading,
-                  eWireframe);
+                  eWireframe,
+                  ePipelineStatistics,
+                  eOcclusionPrecise,
+                  // multiple draws per indirect command and a non zero first instance
+                  eMultiDrawIndirect,
+                  eDrawIndirectCount,
+                  eDescriptorUpdateTemplate,
+                  // update after bind and partially bound descriptor arrays
+                  eDescriptorIndexing,
+                  ePushDescriptor,
+                  // render pipelines linked from separately compiled libraries
+                  eGraphicsPipelineLibrary,
+                  // VK_EXT_extended_dynamic_state, and VK_EXT_extended_dynamic_state2 when available
+                  eExtendedDynamicState,
+                  // VK_EXT_extended_dynamic_state3, polygon mode, depth clamp and color blend/write mask
+                  eExtendedDynamicState3);
 
 SAFE_ENUM_DECLARE(ShaderStage,
                   eVertex                 = VK_SHADER_STAGE_VERTEX_BIT,
@@ -89,7 +104,27 @@ SAFE_ENUM_DECLARE(DynamicState,
                   eStencilReference   = VK_DYNAMIC_STATE_STENCIL_REFERENCE,
                   eLineWidth          = VK_DYNAMIC_STATE_LINE_WIDTH,
                   eViewport           = VK_DYNAMIC_STATE_VIEWPORT,
-                  eScissor            = VK_DYNAMIC_STATE_SCISSOR);
+                  eScissor            = VK_DYNAMIC_STATE_SCISSOR,
+                  // Requires the DeviceFeature::eExtendedDynamicState feature.
+                  eCullMode                = VK_DYNAMIC_STATE_CULL_MODE_EXT,
+                  eFrontFace               = VK_DYNAMIC_STATE_FRONT_FACE_EXT,
+                  ePrimitiveTopology       = VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY_EXT,
+                  eDepthTestEnable         = VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE_EXT,
+                  eDepthWriteEnable        = VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE_EXT,
+                  eDepthCompareOp          = VK_DYNAMIC_STATE_DEPTH_COMPARE_OP_EXT,
+                  eDepthBoundsTestEnable   = VK_DYNAMIC_STATE_DEPTH_BOUNDS_TEST_ENABLE_EXT,
+                  eStencilTestEnable       = VK_DYNAMIC_STATE_STENCIL_TEST_ENABLE_EXT,
+                  eStencilOp               = VK_DYNAMIC_STATE_STENCIL_OP_EXT,
+                  // Optional, check DeviceContext::supportsDynamicState.
+                  eRasterizerDiscardEnable = VK_DYNAMIC_STATE_RASTERIZER_DISCARD_ENABLE_EXT,
+                  eDepthBiasEnable         = VK_DYNAMIC_STATE_DEPTH_BIAS_ENABLE_EXT,
+                  ePrimitiveRestartEnable  = VK_DYNAMIC_STATE_PRIMITIVE_RESTART_ENABLE_EXT,
+                  ePatchControlPoints      = VK_DYNAMIC_STATE_PATCH_CONTROL_POINTS_EXT,
+                  // Requires the DeviceFeature::eExtendedDynamicState3 feature.
+                  ePolygonMode      = VK_DYNAMIC_STATE_POLYGON_MODE_EXT,
+                  eDepthClampEnable = VK_DYNAMIC_STATE_DEPTH_CLAMP_ENABLE_EXT,
+                  eColorBlendEnable = VK_DYNAMIC_STATE_COLOR_BLEND_ENABLE_EXT,
+                  eColorWriteMask   = VK_DYNAMIC_STATE_COLOR_WRITE_MASK_EXT);
 
 SAFE_ENUM_DECLARE(AttributeFormat,
                   eHalfFloat  = VK_FORMAT_R16_SFLOAT,           //
@@ -107,7 +142,15 @@ SAFE_ENUM_DECLARE(AttributeFormat,
                   eShort      = VK_FORMAT_R16_UINT,             //
                   eShort2     = VK_FORMAT_R16G16_UINT,          //
                   eShort3     = VK_FORMAT_R16G16B16_UINT,       //
-                  eShort4     = VK_FORMAT_R16G16B16A16_UINT);
+                  eShort4     = VK_FORMAT_R16G16B16A16_UINT,    //
+                  eInt        = VK_FORMAT_R32_SINT,             //
+                  eInt2       = VK_FORMAT_R32G32_SINT,          //
+                  eInt3       = VK_FORMAT_R32G32B32_SINT,       //
+                  eInt4       = VK_FORMAT_R32G32B32A32_SINT,    //
+                  eUInt       = VK_FORMAT_R32_UINT,             //
+                  eUInt2      = VK_FORMAT_R32G32_UINT,          //
+                  eUInt3      = VK_FORMAT_R32G32B32_UINT,       //
+                  eUInt4      = VK_FORMAT_R32G32B32A32_UINT);
 
 SAFE_ENUM_DECLARE(IndexType,
                   eInt16 = VK_INDEX_TYPE_UINT16,  //
@@ -120,10 +163,18 @@ SAFE_ENUM_DECLARE(BufferUsageFlags,
                   eIndex    = VK_BUFFER_USAGE_INDEX_BUFFER_BIT,                      //
                   eVertex   = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,                     //
                   eIndirect = VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,                   //
+                  eStorage  = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,                    //
+                  eUniformTexel = VK_BUFFER_USAGE_UNIFORM_TEXEL_BUFFER_BIT,          //
+                  eStorageTexel = VK_BUFFER_USAGE_STORAGE_TEXEL_BUFFER_BIT,          //
                   eIndexSrc = eIndex | eSrc, eIndexDst = eIndex | eDst,              //
                   eVertexSrc = eVertex | eSrc, eVertexDst = eVertex | eDst,          //
                   eIndirectSrc = eIndirect | eSrc, eIndirectDst = eIndirect | eDst,  //
-                  eUniformtSrc = eUniform | eSrc, eUniformDst = eUniform | eDst);
+                  eUniformtSrc = eUniform | eSrc, eUniformDst = eUniform | eDst,     //
+                  eStorageSrc = eStorage | eSrc, eStorageDst = eStorage | eDst,      //
+                  eUniformTexelDst = eUniformTexel | eDst,                           //
+                  eStorageTexelDst = eStorageTexel | eDst,                           //
+                  // indirect commands generated on the device
+                  eIndirectStorageDst = eIndirect | eStorage | eDst);
 
 SAFE_ENUM_DECLARE(TextureType,
                   e1D      = VK_IMAGE_VIEW_TYPE_1D,
@@ -167,9 +218,31 @@ SAFE_ENUM_DECLARE(DescriptorType,
                   eSampledImage         = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
                   eImage                = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
                   eTexelBuffer          = VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER,
+                  eUniformTexelBuffer   = VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER,
                   eStorageBuffer        = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
                   eStorageBufferDynamic = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC);
 
+SAFE_ENUM_DECLARE(QueryType,
+                  eOcclusion          = VK_QUERY_TYPE_OCCLUSION,
+                  ePipelineStatistics = VK_QUERY_TYPE_PIPELINE_STATISTICS,
+                  eTimestamp          = VK_QUERY_TYPE_TIMESTAMP);
+
+SAFE_ENUM_DECLARE(PipelineStatistic,
+                  eInputVertices             = VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT,
+                  eInputPrimitives           = VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT,
+                  eVertexInvocations         = VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT,
+                  eGeometryInvocations       = VK_QUERY_PIPELINE_STATISTIC_GEOMETRY_SHADER_INVOCATIONS_BIT,
+                  eGeometryPrimitives        = VK_QUERY_PIPELINE_STATISTIC_GEOMETRY_SHADER_PRIMITIVES_BIT,
+                  eClippingInvocations       = VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT,
+                  eClippingPrimitives        = VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT,
+                  eFragmentInvocations       = VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT,
+                  eTessControlPatches        = VK_QUERY_PIPELINE_STATISTIC_TESSELLATION_CONTROL_SHADER_PATCHES_BIT,
+                  eTessEvaluationInvocations = VK_QUERY_PIPELINE_STATISTIC_TESSELLATION_EVALUATION_SHADER_INVOCATIONS_BIT,
+                  eComputeInvocations        = VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT,
+                  // vertex and fragment invocations with the clipping statistics
+                  eGraphics = eInputVertices | eInputPrimitives | eVertexInvocations | eClippingInvocations |
+                              eClippingPrimitives | eFragmentInvocations);
+
 SAFE_ENUM_DECLARE(ColorFormat,
                   eRed             = VK_FORMAT_R8G8_UNORM,             //
                   eRG              = VK_FORMAT_R8G8_UNORM,             //
@@ -184,6 +257,9 @@ SAFE_ENUM_DECLARE(ColorFormat,
                   eRG32f           = VK_FORMAT_R32G32_SFLOAT,          //
                   eRGB32f          = VK_FORMAT_R32G32B32_SFLOAT,       //
                   eRGBA32f         = VK_FORMAT_R32G32B32A32_SFLOAT,    //
+                  eR32f            = VK_FORMAT_R32_SFLOAT,             //
+                  eR32ui           = VK_FORMAT_R32_UINT,               //
+                  eRGBA32ui        = VK_FORMAT_R32G32B32A32_UINT,      //
                   eDepth32         = VK_FORMAT_D32_SFLOAT,             //
                   eDepth24Stencil8 = VK_FORMAT_D32_SFLOAT_S8_UINT,     //
                   eDepth32Stencil8 = VK_FORMAT_D24_UNORM_S8_UINT,      //
@@ -59,6 +59,8 @@ private:
         const VertexDescription& layout);
     friend const std::vector<VkVertexInputAttributeDescription>& detail::getAttributeDescriptons(
         const VertexDescription& layout);
+    friend const std::vector<VkBuffer>&     detail::getVertexBuffers(const VertexDescription& layout);
+    friend const std::vector<VkDeviceSize>& detail::getVertexBufferOffsets(const VertexDescription& layout);
 };  // class InputLayout
 
 class IndexedVertexDescription : public VertexDescription
@@ -88,6 +90,7 @@ private:
     uint32_t m_bufferSize = 0;
 #endif  // !NDEBUG
 
+    friend detail::IndexBufferInfo detail::getIndexBufferInfo(const IndexedVertexDescription& layout);
 };  // class IndexedInputLayout
 
 inline VertexDescription::VertexDescription() {}
@@ -220,5 +223,17 @@ namespace detail
     {
         return layout.m_vertexAttributeDescriptons;
     }
+    inline const std::vector<VkBuffer>& getVertexBuffers(const VertexDescription& layout)
+    {
+        return layout.m_vertexBuffers;
+    }
+    inline const std::vector<VkDeviceSize>& getVertexBufferOffsets(const VertexDescription& layout)
+    {
+        return layout.m_vertexBufferOffsets;
+    }
+    inline IndexBufferInfo getIndexBufferInfo(const IndexedVertexDescription& layout)
+    {
+        return IndexBufferInfo({layout.m_indexBuffer, layout.m_offset, (VkIndexType)layout.m_indexType});
+    }
 }  // namespace detail
 }  // namespace ri
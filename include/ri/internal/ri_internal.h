@@ -20,6 +20,7 @@ class DeviceContext;
 class RenderPipeline;
 class ComputePipeline;
 class VertexDescription;
+class IndexedVertexDescription;
 template <typename HandleClass>
 class RenderObject;
 class DescriptorPool;
@@ -33,6 +34,48 @@ namespace detail
             assert(!res);
         }
     };
+    /// Device level extension entry points, null if the extension wasn't enabled.
+    struct DeviceFunctions
+    {
+        PFN_vkCmdDrawIndirectCountKHR        cmdDrawIndirectCount        = nullptr;
+        PFN_vkCmdDrawIndexedIndirectCountKHR cmdDrawIndexedIndirectCount = nullptr;
+
+        // VK_KHR_descriptor_update_template
+        PFN_vkCreateDescriptorUpdateTemplateKHR  createDescriptorUpdateTemplate  = nullptr;
+        PFN_vkDestroyDescriptorUpdateTemplateKHR destroyDescriptorUpdateTemplate = nullptr;
+        PFN_vkUpdateDescriptorSetWithTemplateKHR updateDescriptorSetWithTemplate = nullptr;
+
+        // VK_KHR_push_descriptor
+        PFN_vkCmdPushDescriptorSetKHR cmdPushDescriptorSet = nullptr;
+        uint32_t                      maxPushDescriptors   = 0;
+
+        // VK_EXT_extended_dynamic_state
+        PFN_vkCmdSetCullModeEXT              cmdSetCullMode              = nullptr;
+        PFN_vkCmdSetFrontFaceEXT             cmdSetFrontFace             = nullptr;
+        PFN_vkCmdSetPrimitiveTopologyEXT     cmdSetPrimitiveTopology     = nullptr;
+        PFN_vkCmdSetDepthTestEnableEXT       cmdSetDepthTestEnable       = nullptr;
+        PFN_vkCmdSetDepthWriteEnableEXT      cmdSetDepthWriteEnable      = nullptr;
+        PFN_vkCmdSetDepthCompareOpEXT        cmdSetDepthCompareOp        = nullptr;
+        PFN_vkCmdSetDepthBoundsTestEnableEXT cmdSetDepthBoundsTestEnable = nullptr;
+        PFN_vkCmdSetStencilTestEnableEXT     cmdSetStencilTestEnable     = nullptr;
+        PFN_vkCmdSetStencilOpEXT             cmdSetStencilOp             = nullptr;
+        // VK_EXT_extended_dynamic_state2
+        PFN_vkCmdSetRasterizerDiscardEnableEXT cmdSetRasterizerDiscardEnable = nullptr;
+        PFN_vkCmdSetDepthBiasEnableEXT         cmdSetDepthBiasEnable         = nullptr;
+        PFN_vkCmdSetPrimitiveRestartEnableEXT  cmdSetPrimitiveRestartEnable  = nullptr;
+        PFN_vkCmdSetPatchControlPointsEXT      cmdSetPatchControlPoints      = nullptr;
+        // VK_EXT_extended_dynamic_state3
+        PFN_vkCmdSetPolygonModeEXT      cmdSetPolygonMode      = nullptr;
+        PFN_vkCmdSetDepthClampEnableEXT cmdSetDepthClampEnable = nullptr;
+        PFN_vkCmdSetColorBlendEnableEXT cmdSetColorBlendEnable = nullptr;
+        PFN_vkCmdSetColorWriteMaskEXT   cmdSetColorWriteMask   = nullptr;
+    };
+    struct IndexBufferInfo
+    {
+        VkBuffer     buffer;
+        VkDeviceSize offset;
+        VkIndexType  type;
+    };
     struct TextureDescriptorInfo
     {
         VkImageView   imageView;
@@ -56,9 +99,14 @@ namespace detail
     VkQueue                                 getDeviceQueue(const ri::DeviceContext& device, int deviceOperation);
     uint32_t                                getDeviceQueueIndex(const ri::DeviceContext& device, int deviceOperation);
     const VkPhysicalDeviceMemoryProperties& getDeviceMemoryProperties(const ri::DeviceContext& device);
+    const DeviceFunctions&                  getDeviceFunctions(const ri::DeviceContext& device);
+    const DeviceFunctions&                  getDeviceFunctions(const ri::CommandBuffer& buffer);
 
     const std::vector<VkVertexInputBindingDescription>&   getBindingDescriptions(const VertexDescription& layout);
     const std::vector<VkVertexInputAttributeDescription>& getAttributeDescriptons(const VertexDescription& layout);
+    const std::vector<VkBuffer>&                          getVertexBuffers(const VertexDescription& layout);
+    const std::vector<VkDeviceSize>&                      getVertexBufferOffsets(const VertexDescription& layout);
+    IndexBufferInfo                                       getIndexBufferInfo(const IndexedVertexDescription& layout);
 
     VkPipelineLayout getPipelineLayout(const RenderPipeline& pipeline);
     VkPipelineLayout getPipelineLayout(const ComputePipeline& pipeline);
@@ -21,8 +21,9 @@ namespace detail
 {
     struct CommandBufferStorage : public RenderObject<VkCommandBuffer>
     {
-        VkCommandPool m_commandPool;
-        VkDevice      m_device;
+        VkCommandPool          m_commandPool;
+        VkDevice               m_device;
+        const DeviceFunctions* m_functions;
 
         inline CommandBuffer& cast()
         {
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <string>
+#include <util/noncopyable.h>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace util
+{
+/**
+ * @brief Read only memory mapping of a whole file, the contents are paged in on access without an intermediate copy.
+ *
+ * @example util::MappedFile file("shader.vert.spv");
+ * if (file.isOpen())
+ *     consume(file.data(), file.size());
+ **/
+class MappedFile : noncopyable
+{
+public:
+    explicit MappedFile(const std::string& filename);
+    ~MappedFile();
+
+    /// @return false if the file doesn't exist, is empty or couldn't be mapped.
+    bool isOpen() const;
+    /// @note The mapping is page aligned.
+    const void* data() const;
+    size_t      size() const;
+
+private:
+    const void* m_data = nullptr;
+    size_t      m_size = 0;
+#ifdef _WIN32
+    HANDLE m_file    = INVALID_HANDLE_VALUE;
+    HANDLE m_mapping = nullptr;
+#endif
+};
+
+#ifdef _WIN32
+inline MappedFile::MappedFile(const std::string& filename)
+{
+    m_file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                         FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE)
+        return;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(m_file, &fileSize) || !fileSize.QuadPart)
+        return;
+
+    m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m_mapping)
+        return;
+
+    m_data = MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+    if (m_data)
+        m_size = (size_t)fileSize.QuadPart;
+}
+
+inline MappedFile::~MappedFile()
+{
+    if (m_data)
+        UnmapViewOfFile(m_data);
+    if (m_mapping)
+        CloseHandle(m_mapping);
+    if (m_file != INVALID_HANDLE_VALUE)
+        CloseHandle(m_file);
+}
+#else
+inline MappedFile::MappedFile(const std::string& filename)
+{
+    const int file = open(filename.c_str(), O_RDONLY);
+    if (file < 0)
+        return;
+
+    struct stat fileStat;
+    if (fstat(file, &fileStat) == 0 && fileStat.st_size > 0)
+    {
+        void* data = mmap(nullptr, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+        if (data != MAP_FAILED)
+        {
+            m_data = data;
+            m_size = (size_t)fileStat.st_size;
+        }
+    }
+    // the mapping keeps a reference to the file
+    close(file);
+}
+
+inline MappedFile::~MappedFile()
+{
+    if (m_data)
+        munmap(const_cast<void*>(m_data), m_size);
+}
+#endif
+
+inline bool MappedFile::isOpen() const
+{
+    return m_data != nullptr;
+}
+
+inline const void* MappedFile::data() const
+{
+    return m_data;
+}
+
+inline size_t MappedFile::size() const
+{
+    return m_size;
+}
+}  // namespace util
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cassert>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+#include <util/noncopyable.h>
+
+namespace util
+{
+/**
+ * @brief Fixed count of worker threads consuming a FIFO task queue.
+ *
+ * @example util::ThreadPool pool(4);
+ * std::future<int> result = pool.submit([]() { return 42; });
+ * result.get();
+ **/
+class ThreadPool : noncopyable
+{
+public:
+    ///@param threadCount By default one per hardware thread.
+    explicit ThreadPool(size_t threadCount = std::thread::hardware_concurrency());
+    /// Finishes the queued tasks before joining the workers.
+    ~ThreadPool();
+
+    template <typename Task>
+    std::future<typename std::result_of<Task()>::type> submit(Task&& task);
+
+    size_t threadCount() const;
+
+private:
+    void work();
+
+private:
+    std::vector<std::thread>          m_workers;
+    std::queue<std::function<void()>> m_tasks;
+    std::mutex                        m_mutex;
+    std::condition_variable           m_condition;
+    bool                              m_stopping = false;
+};
+
+inline ThreadPool::ThreadPool(size_t threadCount /*= std::thread::hardware_concurrency()*/)
+{
+    if (!threadCount)
+        threadCount = 1;
+    m_workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i)
+        m_workers.emplace_back(&ThreadPool::work, this);
+}
+
+inline ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_condition.notify_all();
+    for (auto& worker : m_workers)
+        worker.join();
+}
+
+template <typename Task>
+std::future<typename std::result_of<Task()>::type> ThreadPool::submit(Task&& task)
+{
+    typedef typename std::result_of<Task()>::type Result;
+
+    // std::function requires a copyable target
+    auto packagedTask = std::make_shared<std::packaged_task<Result()> >(std::forward<Task>(task));
+    auto future       = packagedTask->get_future();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        assert(!m_stopping);
+        m_tasks.emplace([packagedTask]() { (*packagedTask)(); });
+    }
+    m_condition.notify_one();
+    return future;
+}
+
+inline size_t ThreadPool::threadCount() const
+{
+    return m_workers.size();
+}
+
+inline void ThreadPool::work()
+{
+    for (;;)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this]() { return m_stopping || !m_tasks.empty(); });
+            if (m_tasks.empty())
+                return;  // stopping and drained
+
+            task = std::move(m_tasks.front());
+            m_tasks.pop();
+        }
+        task();
+    }
+}
+}  // namespace util
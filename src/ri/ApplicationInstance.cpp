@@ -1,6 +1,7 @@
 
 #include <ri/ApplicationInstance.h>
 
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 #include <ri/ValidationReport.h>
@@ -50,13 +51,6 @@ ApplicationInstance::ApplicationInstance(const std::string& name, const std::str
     createInfo.sType                = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
     createInfo.pApplicationInfo     = &appInfo;
 
-    std::vector<const char*> extensions = getRequiredExtensions();
-    createInfo.enabledExtensionCount    = extensions.size();
-    createInfo.ppEnabledExtensionNames  = extensions.data();
-    std::vector<const char*> layers     = ri::ValidationReport::getActiveLayers();
-    createInfo.enabledLayerCount        = static_cast<uint32_t>(layers.size());
-    createInfo.ppEnabledLayerNames      = layers.data();
-
     uint32_t extensionCount = 0;
     vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
 
@@ -70,7 +64,15 @@ ApplicationInstance::ApplicationInstance(const std::string& name, const std::str
     }
 #endif  // ! NDEBUG
 
+    std::vector<const char*> extensions = getRequiredExtensions(extensionProperties);
+    createInfo.enabledExtensionCount    = extensions.size();
+    createInfo.ppEnabledExtensionNames  = extensions.data();
+    std::vector<const char*> layers     = ri::ValidationReport::getActiveLayers();
+    createInfo.enabledLayerCount        = static_cast<uint32_t>(layers.size());
+    createInfo.ppEnabledLayerNames      = layers.data();
+
     RI_CHECK_RESULT_MSG("couldn't create application instance") = vkCreateInstance(&createInfo, nullptr, &m_handle);
+    m_extensions.assign(extensions.begin(), extensions.end());
 }
 
 ApplicationInstance::~ApplicationInstance()
@@ -78,7 +80,13 @@ ApplicationInstance::~ApplicationInstance()
     vkDestroyInstance(m_handle, nullptr);
 }
 
-std::vector<const char*> ApplicationInstance::getRequiredExtensions()
+bool ApplicationInstance::extensionEnabled(const char* extensionName) const
+{
+    return std::find(m_extensions.begin(), m_extensions.end(), extensionName) != m_extensions.end();
+}
+
+std::vector<const char*> ApplicationInstance::getRequiredExtensions(
+    const std::vector<VkExtensionProperties>& availableExtensions)
 {
     std::vector<const char*> extensions;
 
@@ -106,6 +114,16 @@ std::vector<const char*> ApplicationInstance::getRequiredExtensions()
         extensions.push_back(VK_EXT_DEBUG_REPORT_EXTENSION_NAME);
     }
 
+    // required by the device extensions on a 1.0 instance, eg. push descriptors and descriptor indexing
+    for (const auto& extension : availableExtensions)
+    {
+        if (std::string(extension.extensionName) == VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME)
+        {
+            extensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+            break;
+        }
+    }
+
     return extensions;
 }
 }  // namespace ri
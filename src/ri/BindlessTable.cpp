@@ -0,0 +1,164 @@
+
+#include <ri/BindlessTable.h>
+
+#include <algorithm>
+#include <ri/Buffer.h>
+#include <ri/DeviceContext.h>
+#include <ri/Texture.h>
+
+namespace ri
+{
+BindlessTable::BindlessTable(const DeviceContext& device, uint32_t maxTextures /*= 4096*/,
+                             uint32_t maxBuffers /*= 1024*/)
+    : m_device(detail::getVkHandle(device))
+{
+    assert(maxTextures && maxBuffers);
+    m_textures.maxCount = maxTextures;
+    m_buffers.maxCount  = maxBuffers;
+
+    VkDescriptorPoolSize poolSizes[2];
+    poolSizes[0].type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    poolSizes[0].descriptorCount = maxTextures;
+    poolSizes[1].type            = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSizes[1].descriptorCount = maxBuffers;
+
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType                      = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount              = 2;
+    poolInfo.pPoolSizes                 = poolSizes;
+    poolInfo.maxSets                    = 1;
+    poolInfo.flags                      = DescriptorPool::eUpdateAfterBind;
+
+    RI_CHECK_RESULT_MSG("couldn't create bindless descriptor pool") =
+        vkCreateDescriptorPool(m_device, &poolInfo, nullptr, &m_pool);
+
+    VkDescriptorSetLayoutBinding bindings[2] = {};
+    bindings[0].binding                      = eTexturesBinding;
+    bindings[0].descriptorType               = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    bindings[0].descriptorCount              = maxTextures;
+    bindings[0].stageFlags                   = VK_SHADER_STAGE_ALL;
+    bindings[1].binding                      = eBuffersBinding;
+    bindings[1].descriptorType               = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    bindings[1].descriptorCount              = maxBuffers;
+    bindings[1].stageFlags                   = VK_SHADER_STAGE_ALL;
+
+    // unused array elements don't need to be valid and can be written while the set is bound
+    const VkDescriptorBindingFlagsEXT bindingFlags[2] = {
+        VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT |
+            VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT,
+        VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT |
+            VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT};
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfoEXT bindingFlagsInfo = {};
+    bindingFlagsInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
+    bindingFlagsInfo.bindingCount  = 2;
+    bindingFlagsInfo.pBindingFlags = bindingFlags;
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+    layoutInfo.sType                           = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.pNext                           = &bindingFlagsInfo;
+    layoutInfo.flags                           = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT;
+    layoutInfo.bindingCount                    = 2;
+    layoutInfo.pBindings                       = bindings;
+
+    RI_CHECK_RESULT_MSG("couldn't create bindless descriptor set layout") =
+        vkCreateDescriptorSetLayout(m_device, &layoutInfo, nullptr, &m_layout);
+
+    VkDescriptorSetAllocateInfo allocInfo = {};
+    allocInfo.sType                       = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool              = m_pool;
+    allocInfo.descriptorSetCount          = 1;
+    allocInfo.pSetLayouts                 = &m_layout;
+
+    VkDescriptorSet handle;
+    RI_CHECK_RESULT_MSG("couldn't allocate bindless descriptor set") =
+        vkAllocateDescriptorSets(m_device, &allocInfo, &handle);
+    m_descriptor = DescriptorSet(m_device, handle);
+}
+
+BindlessTable::~BindlessTable()
+{
+    vkDestroyDescriptorPool(m_device, m_pool, nullptr);
+    vkDestroyDescriptorSetLayout(m_device, m_layout, nullptr);
+}
+
+uint32_t BindlessTable::add(const Texture& texture)
+{
+    const uint32_t index = m_textures.acquire();
+    update(index, texture);
+    return index;
+}
+
+uint32_t BindlessTable::add(const Buffer& buffer)
+{
+    const uint32_t index = m_buffers.acquire();
+    update(index, buffer);
+    return index;
+}
+
+void BindlessTable::update(uint32_t textureIndex, const Texture& texture)
+{
+    assert(textureIndex < m_textures.count);
+
+    const auto&           textureInfo = detail::getTextureDescriptorInfo(texture);
+    VkDescriptorImageInfo imageInfo   = {textureInfo.sampler, textureInfo.imageView, textureInfo.layout};
+    write(eTexturesBinding, textureIndex, &imageInfo, nullptr);
+}
+
+void BindlessTable::update(uint32_t bufferIndex, const Buffer& buffer)
+{
+    assert(bufferIndex < m_buffers.count);
+    assert(buffer.bufferUsage().get() & BufferUsageFlags::eStorage);
+
+    VkDescriptorBufferInfo bufferInfo = {detail::getVkHandle(buffer), 0, VK_WHOLE_SIZE};
+    write(eBuffersBinding, bufferIndex, nullptr, &bufferInfo);
+}
+
+void BindlessTable::removeTexture(uint32_t textureIndex)
+{
+    m_textures.release(textureIndex);
+}
+
+void BindlessTable::removeBuffer(uint32_t bufferIndex)
+{
+    m_buffers.release(bufferIndex);
+}
+
+void BindlessTable::write(uint32_t binding, uint32_t index, const VkDescriptorImageInfo* imageInfo,
+                          const VkDescriptorBufferInfo* bufferInfo)
+{
+    VkWriteDescriptorSet descriptorWrite = {};
+    descriptorWrite.sType                = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrite.dstSet               = detail::getVkHandle(m_descriptor);
+    descriptorWrite.dstBinding           = binding;
+    descriptorWrite.dstArrayElement      = index;
+    descriptorWrite.descriptorCount      = 1;
+    descriptorWrite.descriptorType =
+        imageInfo ? VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    descriptorWrite.pImageInfo  = imageInfo;
+    descriptorWrite.pBufferInfo = bufferInfo;
+
+    vkUpdateDescriptorSets(m_device, 1, &descriptorWrite, 0, nullptr);
+}
+
+uint32_t BindlessTable::Slots::acquire()
+{
+    if (!freeIndices.empty())
+    {
+        const uint32_t index = freeIndices.back();
+        freeIndices.pop_back();
+        return index;
+    }
+
+    assert(count < maxCount);
+    return count++;
+}
+
+void BindlessTable::Slots::release(uint32_t index)
+{
+    assert(index < count);
+    assert(std::find(freeIndices.begin(), freeIndices.end(), index) == freeIndices.end());
+    freeIndices.push_back(index);
+}
+
+}  // namespace ri
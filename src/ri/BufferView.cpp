@@ -0,0 +1,44 @@
+
+#include <ri/BufferView.h>
+
+#include <ri/Buffer.h>
+#include <ri/DeviceContext.h>
+
+namespace ri
+{
+BufferView::BufferView(const DeviceContext& device, const Buffer& buffer, ColorFormat format,
+                       size_t offset /*= 0*/, size_t size /*= VK_WHOLE_SIZE*/)
+    : m_device(detail::getVkHandle(device))
+    , m_buffer(buffer)
+    , m_format(format)
+    , m_offset(offset)
+    , m_size(size == VK_WHOLE_SIZE ? buffer.bytes() - offset : size)
+{
+    const uint32_t usage = buffer.bufferUsage().get();
+    assert(usage & (BufferUsageFlags::eUniformTexel | BufferUsageFlags::eStorageTexel));
+    assert(offset % device.deviceProperties().limits.minTexelBufferOffsetAlignment == 0);
+    assert(offset + m_size <= buffer.bytes());
+    assert(!(usage & BufferUsageFlags::eUniformTexel) || isFormatSupported(device, format, false));
+    assert(!(usage & BufferUsageFlags::eStorageTexel) || isFormatSupported(device, format, true));
+
+    VkBufferViewCreateInfo viewInfo = {};
+    viewInfo.sType                  = VK_STRUCTURE_TYPE_BUFFER_VIEW_CREATE_INFO;
+    viewInfo.buffer                 = detail::getVkHandle(buffer);
+    viewInfo.format                 = (VkFormat)format;
+    viewInfo.offset                 = offset;
+    viewInfo.range                  = size;
+
+    RI_CHECK_RESULT_MSG("couldn't create buffer view") = vkCreateBufferView(m_device, &viewInfo, nullptr, &m_handle);
+}
+
+bool BufferView::isFormatSupported(const DeviceContext& device, ColorFormat format, bool storage)
+{
+    VkFormatProperties props;
+    vkGetPhysicalDeviceFormatProperties(detail::getDevicePhysicalHandle(device), (VkFormat)format, &props);
+
+    const VkFormatFeatureFlags feature =
+        storage ? VK_FORMAT_FEATURE_STORAGE_TEXEL_BUFFER_BIT : VK_FORMAT_FEATURE_UNIFORM_TEXEL_BUFFER_BIT;
+    return (props.bufferFeatures & feature) != 0;
+}
+
+}  // namespace ri
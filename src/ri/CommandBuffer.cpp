@@ -0,0 +1,63 @@
+
+#include <ri/CommandBuffer.h>
+
+#include <vector>
+#include <ri/ComputePipeline.h>
+#include <ri/DescriptorSet.h>
+#include <ri/RenderPipeline.h>
+
+namespace ri
+{
+namespace
+{
+    // the minimum of the maxPushDescriptors limit, pushes up to it are written on the stack
+    const size_t kMinMaxPushDescriptors = 32;
+}
+
+void CommandBuffer::pushDescriptors(const RenderPipeline& pipeline, uint32_t setIndex,
+                                    const DescriptorSetParams& params)
+{
+    pushDescriptors(VK_PIPELINE_BIND_POINT_GRAPHICS, detail::getPipelineLayout(pipeline), setIndex, params);
+}
+
+void CommandBuffer::pushDescriptors(const ComputePipeline& pipeline, uint32_t setIndex,
+                                    const DescriptorSetParams& params)
+{
+    pushDescriptors(VK_PIPELINE_BIND_POINT_COMPUTE, detail::getPipelineLayout(pipeline), setIndex, params);
+}
+
+void CommandBuffer::pushDescriptors(VkPipelineBindPoint bindPoint, VkPipelineLayout layout, uint32_t setIndex,
+                                    const DescriptorSetParams& params)
+{
+    assert(m_functions && m_functions->cmdPushDescriptorSet);
+    const size_t descriptorCount = DescriptorSet::descriptorCount(params);
+    assert(descriptorCount <= m_functions->maxPushDescriptors);
+
+    DescriptorSet::DescriptorInfo              stackDescriptorInfos[kMinMaxPushDescriptors];
+    VkWriteDescriptorSet                       stackDescriptorWriteInfos[kMinMaxPushDescriptors];
+    std::vector<DescriptorSet::DescriptorInfo> heapDescriptorInfos;
+    std::vector<VkWriteDescriptorSet>          heapDescriptorWriteInfos;
+    DescriptorSet::DescriptorInfo*             descriptorInfos      = stackDescriptorInfos;
+    VkWriteDescriptorSet*                      descriptorWriteInfos = stackDescriptorWriteInfos;
+    if (descriptorCount > kMinMaxPushDescriptors)
+    {
+        heapDescriptorInfos.resize(descriptorCount);
+        heapDescriptorWriteInfos.resize(params.infos.size());
+        descriptorInfos      = heapDescriptorInfos.data();
+        descriptorWriteInfos = heapDescriptorWriteInfos.data();
+    }
+
+    size_t i = 0, j = 0;
+    for (const auto& writeInfo : params.infos)
+    {
+        // the destination set is ignored for pushed descriptors
+        DescriptorSet::setInfos(writeInfo, VK_NULL_HANDLE, descriptorInfos + j, descriptorWriteInfos[i]);
+        j += writeInfo.count;
+        ++i;
+    }
+
+    if (i)
+        m_functions->cmdPushDescriptorSet(m_handle, bindPoint, layout, setIndex, i, descriptorWriteInfos);
+}
+
+}  // namespace ri
@@ -3,6 +3,7 @@
 
 #include <algorithm>
 #include <ri/CommandBuffer.h>
+#include <ri/DeviceContext.h>
 
 namespace ri
 {
@@ -23,7 +24,7 @@ CommandPool::~CommandPool()
 CommandBuffer CommandPool::create(bool isPrimary /*= true*/)
 {
     assert(m_device && m_handle);
-    return CommandBuffer(detail::getVkHandle(*m_device), m_handle, isPrimary);
+    return CommandBuffer(detail::getVkHandle(*m_device), m_handle, &detail::getDeviceFunctions(*m_device), isPrimary);
 }
 
 void CommandPool::create(CommandBuffer* buffers, size_t buffersCount, bool isPrimary /*= true*/)
@@ -45,7 +46,8 @@ void CommandPool::create(CommandBuffer* buffers, size_t buffersCount, bool isPri
     std::transform(bufferHandles.begin(), bufferHandles.end(), buffers,
                    [this, isPrimary](auto handle) -> CommandBuffer {
                        assert(handle);
-                       return CommandBuffer(detail::getVkHandle(*m_device), m_handle, handle);
+                       return CommandBuffer(detail::getVkHandle(*m_device), m_handle,
+                                            &detail::getDeviceFunctions(*m_device), handle);
                    });
 }
 
@@ -57,7 +59,8 @@ void CommandPool::create(std::vector<CommandBuffer>& buffers, bool isPrimary /*=
 
 CommandBuffer CommandPool::begin()
 {
-    CommandBuffer commandBuffer(detail::getVkHandle(*m_device), m_handle, true);
+    CommandBuffer commandBuffer(detail::getVkHandle(*m_device), m_handle, &detail::getDeviceFunctions(*m_device),
+                                true);
     commandBuffer.begin(RecordFlags::eOneTime);
 
     return commandBuffer;
@@ -0,0 +1,258 @@
+
+#include <ri/CommandRecorder.h>
+
+#include <algorithm>
+#include <cstring>
+#include <ri/CommandBuffer.h>
+#include <ri/ComputePipeline.h>
+#include <ri/DescriptorSet.h>
+#include <ri/RenderPipeline.h>
+#include <ri/VertexDescription.h>
+
+namespace ri
+{
+namespace
+{
+    const VkPipelineBindPoint kBindPoints[] = {VK_PIPELINE_BIND_POINT_GRAPHICS, VK_PIPELINE_BIND_POINT_COMPUTE};
+}
+
+CommandRecorder::CommandRecorder(CommandBuffer& buffer)
+    : m_buffer(&buffer)
+{
+    reset();
+}
+
+void CommandRecorder::reset()
+{
+    for (auto& state : m_bindPoints)
+        state = BindPointState();
+    m_vertexBuffers.fill(VK_NULL_HANDLE);
+    m_vertexBufferOffsets.fill(0);
+    m_indexBuffer = detail::IndexBufferInfo({VK_NULL_HANDLE, 0, VK_INDEX_TYPE_UINT16});
+    m_hasViewport = false;
+    m_hasScissor  = false;
+}
+
+void CommandRecorder::bind(const RenderPipeline& pipeline)
+{
+    bind(eGraphics, detail::getVkHandle(pipeline));
+}
+
+void CommandRecorder::bind(const ComputePipeline& pipeline)
+{
+    bind(eCompute, detail::getVkHandle(pipeline));
+}
+
+void CommandRecorder::bind(const DescriptorSet& descriptor, const RenderPipeline& pipeline, uint32_t setIndex /*= 0*/,
+                           const uint32_t* dynamicOffsets /*= nullptr*/, uint32_t dynamicOffsetCount /*= 0*/)
+{
+    bind(eGraphics, detail::getVkHandle(descriptor), detail::getPipelineLayout(pipeline), setIndex, dynamicOffsets,
+         dynamicOffsetCount);
+}
+
+void CommandRecorder::bind(const DescriptorSet& descriptor, const ComputePipeline& pipeline,
+                           uint32_t setIndex /*= 0*/, const uint32_t* dynamicOffsets /*= nullptr*/,
+                           uint32_t dynamicOffsetCount /*= 0*/)
+{
+    bind(eCompute, detail::getVkHandle(descriptor), detail::getPipelineLayout(pipeline), setIndex, dynamicOffsets,
+         dynamicOffsetCount);
+}
+
+void CommandRecorder::bind(const VertexDescription& description)
+{
+    const auto& buffers = detail::getVertexBuffers(description);
+    const auto& offsets = detail::getVertexBufferOffsets(description);
+    assert(!buffers.empty());
+    assert(buffers.size() <= kMaxVertexBuffers);
+
+    // only bind the range of bindings that changed
+    size_t first = buffers.size(), last = 0;
+    for (size_t i = 0; i < buffers.size(); ++i)
+    {
+        if (m_vertexBuffers[i] != buffers[i] || m_vertexBufferOffsets[i] != offsets[i])
+        {
+            first = std::min(first, i);
+            last  = i;
+        }
+    }
+
+    if (!track(eVertexBuffers, first < buffers.size()))
+        return;
+
+    const uint32_t count = last - first + 1;
+    std::copy(buffers.begin() + first, buffers.begin() + last + 1, m_vertexBuffers.begin() + first);
+    std::copy(offsets.begin() + first, offsets.begin() + last + 1, m_vertexBufferOffsets.begin() + first);
+    vkCmdBindVertexBuffers(detail::getVkHandle(*m_buffer), first, count, buffers.data() + first,
+                           offsets.data() + first);
+}
+
+void CommandRecorder::bind(const IndexedVertexDescription& description)
+{
+    bind(static_cast<const VertexDescription&>(description));
+
+    const detail::IndexBufferInfo info = detail::getIndexBufferInfo(description);
+    assert(info.buffer);
+    const bool changed = m_indexBuffer.buffer != info.buffer || m_indexBuffer.offset != info.offset ||
+                         m_indexBuffer.type != info.type;
+    if (!track(eIndexBuffer, changed))
+        return;
+
+    m_indexBuffer = info;
+    vkCmdBindIndexBuffer(detail::getVkHandle(*m_buffer), info.buffer, info.offset, info.type);
+}
+
+void CommandRecorder::bindIndexBuffer(const Buffer& buffer, IndexType indexType, size_t offset /*= 0*/)
+{
+    assert(buffer.bufferUsage().get() & BufferUsageFlags::eIndex);
+
+    const detail::IndexBufferInfo info = {detail::getVkHandle(buffer), offset, (VkIndexType)indexType};
+    const bool                    changed =
+        m_indexBuffer.buffer != info.buffer || m_indexBuffer.offset != info.offset || m_indexBuffer.type != info.type;
+    if (!track(eIndexBuffer, changed))
+        return;
+
+    m_indexBuffer = info;
+    vkCmdBindIndexBuffer(detail::getVkHandle(*m_buffer), info.buffer, info.offset, info.type);
+}
+
+void CommandRecorder::setViewport(const Sizei& viewportSize, int32_t viewportX /*= 0*/, int32_t viewportY /*= 0*/,
+                                  float minDepth /*= 0.f*/, float maxDepth /*= 1.f*/)
+{
+    VkViewport viewport;
+    viewport.x        = (float)viewportX;
+    viewport.y        = (float)viewportY;
+    viewport.width    = (float)viewportSize.width;
+    viewport.height   = (float)viewportSize.height;
+    viewport.minDepth = minDepth;
+    viewport.maxDepth = maxDepth;
+
+    const bool changed = !m_hasViewport || std::memcmp(&m_viewport, &viewport, sizeof(VkViewport)) != 0;
+    if (!track(eViewport, changed))
+        return;
+
+    m_viewport    = viewport;
+    m_hasViewport = true;
+    vkCmdSetViewport(detail::getVkHandle(*m_buffer), 0, 1, &m_viewport);
+}
+
+void CommandRecorder::setScissor(const Sizei& viewportSize, int32_t viewportX /*= 0*/, int32_t viewportY /*= 0*/)
+{
+    VkRect2D scissor;
+    scissor.offset = {viewportX, viewportY};
+    scissor.extent = {viewportSize.width, viewportSize.height};
+
+    const bool changed = !m_hasScissor || std::memcmp(&m_scissor, &scissor, sizeof(VkRect2D)) != 0;
+    if (!track(eScissor, changed))
+        return;
+
+    m_scissor    = scissor;
+    m_hasScissor = true;
+    vkCmdSetScissor(detail::getVkHandle(*m_buffer), 0, 1, &m_scissor);
+}
+
+void CommandRecorder::pushConstants(const RenderPipeline& pipeline, ShaderStage stages, const void* src,
+                                    uint32_t offset, uint32_t size)
+{
+    pushConstants(eGraphics, detail::getPipelineLayout(pipeline), (VkShaderStageFlags)stages, src, offset, size);
+}
+
+void CommandRecorder::pushConstants(const ComputePipeline& pipeline, const void* src, uint32_t offset, uint32_t size)
+{
+    pushConstants(eCompute, detail::getPipelineLayout(pipeline), VK_SHADER_STAGE_COMPUTE_BIT, src, offset, size);
+}
+
+void CommandRecorder::draw(uint32_t vertexCount, uint32_t instanceCount /*= 1*/,  //
+                           uint32_t offsetVertexIndex /*= 0*/, uint32_t offsetInstanceIndex /*= 0*/)
+{
+    assert(m_bindPoints[eGraphics].pipeline);
+    m_buffer->draw(vertexCount, instanceCount, offsetVertexIndex, offsetInstanceIndex);
+}
+
+void CommandRecorder::drawIndexed(uint32_t indexCount, uint32_t instanceCount /*= 1*/, uint32_t offsetIndex /*= 0*/,
+                                  int32_t offsetVertexIndex /*= 0*/, uint32_t offsetInstanceIndex /*= 0*/)
+{
+    assert(m_bindPoints[eGraphics].pipeline);
+    assert(m_indexBuffer.buffer);
+    m_buffer->drawIndexed(indexCount, instanceCount, offsetIndex, offsetVertexIndex, offsetInstanceIndex);
+}
+
+void CommandRecorder::bind(BindPoint bindPoint, VkPipeline pipeline)
+{
+    assert(pipeline);
+    auto& state = m_bindPoints[bindPoint];
+    if (!track(ePipeline, state.pipeline != pipeline))
+        return;
+
+    // binding a pipeline doesn't disturb the descriptor sets or push constants, but a pipeline without a dynamic
+    // viewport or scissor overwrites them and a later pipeline with them dynamic starts undefined
+    state.pipeline = pipeline;
+    if (bindPoint == eGraphics)
+    {
+        m_hasViewport = false;
+        m_hasScissor  = false;
+    }
+    vkCmdBindPipeline(detail::getVkHandle(*m_buffer), kBindPoints[bindPoint], pipeline);
+}
+
+void CommandRecorder::bind(BindPoint bindPoint, VkDescriptorSet descriptor, VkPipelineLayout layout,
+                           uint32_t setIndex, const uint32_t* dynamicOffsets, uint32_t dynamicOffsetCount)
+{
+    assert(descriptor && layout);
+    assert(setIndex < kMaxDescriptorSets);
+    assert(dynamicOffsetCount <= kMaxDynamicOffsets);
+    assert(!dynamicOffsetCount || dynamicOffsets);
+
+    auto&      sets    = m_bindPoints[bindPoint].descriptorSets;
+    const bool changed = !sets[setIndex].equal(descriptor, layout, dynamicOffsets, dynamicOffsetCount);
+    if (!track(eDescriptorSet, changed))
+        return;
+
+    // conservatively assume that sets bound with another layout are disturbed
+    for (auto& set : sets)
+    {
+        if (set.layout != layout)
+            set = DescriptorSetState();
+    }
+    auto& set              = sets[setIndex];
+    set.handle             = descriptor;
+    set.layout             = layout;
+    set.dynamicOffsetCount = dynamicOffsetCount;
+    std::copy(dynamicOffsets, dynamicOffsets + dynamicOffsetCount, set.dynamicOffsets.begin());
+    vkCmdBindDescriptorSets(detail::getVkHandle(*m_buffer), kBindPoints[bindPoint], layout, setIndex, 1, &descriptor,
+                            dynamicOffsetCount, dynamicOffsets);
+}
+
+void CommandRecorder::pushConstants(BindPoint bindPoint, VkPipelineLayout layout, VkShaderStageFlags stages,
+                                    const void* src, uint32_t offset, uint32_t size)
+{
+    assert(src && size);
+
+    auto& state = m_bindPoints[bindPoint];
+    if (state.pushLayout != layout)
+    {
+        state.pushLayout = layout;
+        state.pushConstants.clear();
+    }
+
+    auto found = std::find_if(state.pushConstants.begin(), state.pushConstants.end(),
+                              [stages, offset, size](const PushConstantState& range) {
+                                  return range.stages == stages && range.offset == offset && range.data.size() == size;
+                              });
+    const bool changed = found == state.pushConstants.end() || std::memcmp(found->data.data(), src, size) != 0;
+    if (!track(ePushConstants, changed))
+        return;
+
+    // remove the ranges that are overwritten
+    state.pushConstants.erase(std::remove_if(state.pushConstants.begin(), state.pushConstants.end(),
+                                             [stages, offset, size](const PushConstantState& range) {
+                                                 return (range.stages & stages) && range.offset < (offset + size) &&
+                                                        offset < (range.offset + range.data.size());
+                                             }),
+                              state.pushConstants.end());
+
+    const uint8_t* data = static_cast<const uint8_t*>(src);
+    state.pushConstants.push_back(PushConstantState({stages, offset, std::vector<uint8_t>(data, data + size)}));
+    vkCmdPushConstants(detail::getVkHandle(*m_buffer), layout, stages, offset, size, src);
+}
+
+}  // namespace ri
@@ -2,7 +2,11 @@
 #include <ri/ComputePipeline.h>
 
 #include <ri/DescriptorSet.h>
+#include <ri/DeviceContext.h>
+#include <ri/PipelineCache.h>
+#include <ri/PipelineLayoutCache.h>
 #include <ri/ShaderModule.h>
+#include <ri/SpecializationConstants.h>
 
 namespace ri
 {
@@ -19,7 +23,7 @@ ComputePipeline::ComputePipeline(const ri::DeviceContext& device,            //
                                  const ri::ShaderModule&  shaderModule,      //
                                  const std::string&       procedureName)
 {
-    m_pipelineLayout = createLayout(detail::getVkHandle(device), {descriptorLayout}, {});
+    m_pipelineLayout = createLayout(device, {descriptorLayout}, {});
     m_device         = detail::getVkHandle(device);
 
     VkComputePipelineCreateInfo info = {VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO};
@@ -29,7 +33,7 @@ ComputePipeline::ComputePipeline(const ri::DeviceContext& device,            //
     info.stage.pName                 = procedureName.c_str();
     info.layout                      = m_pipelineLayout;
     RI_CHECK_RESULT_MSG("couldn't create compute pipeline") =
-        vkCreateComputePipelines(detail::getVkHandle(device), VK_NULL_HANDLE, 1, &info, nullptr, &m_handle);
+        vkCreateComputePipelines(m_device, detail::getVkHandle(device.pipelineCache()), 1, &info, nullptr, &m_handle);
 }
 
 ComputePipeline::ComputePipeline(const ri::DeviceContext& device,            //
@@ -46,35 +50,44 @@ ComputePipeline::ComputePipeline(const ri::DeviceContext&       device,
                                  const ri::ShaderModule&        shaderModule,      //
                                  const std::vector<PushParams>& pushConstants,     //
                                  const std::string&             procedureName)
+    : ComputePipeline(device, descriptorLayout, shaderModule, pushConstants, SpecializationConstants(), procedureName)
 {
-    m_pipelineLayout = createLayout(detail::getVkHandle(device), {descriptorLayout}, pushConstants);
+}
+
+ComputePipeline::ComputePipeline(const ri::DeviceContext&       device,            //
+                                 DescriptorSetLayout            descriptorLayout,  //
+                                 const ri::ShaderModule&        shaderModule,      //
+                                 const std::vector<PushParams>& pushConstants,     //
+                                 const SpecializationConstants& constants,         //
+                                 const std::string&             procedureName /* = "main"*/)
+{
+    m_pipelineLayout = createLayout(device, {descriptorLayout}, pushConstants);
     m_device         = detail::getVkHandle(device);
 
+    const VkSpecializationInfo specialization = constants.info();
+
     VkComputePipelineCreateInfo info = {VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO};
     info.stage.sType                 = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
     info.stage.stage                 = VK_SHADER_STAGE_COMPUTE_BIT;
     info.stage.module                = detail::getVkHandle(shaderModule);
     info.stage.pName                 = procedureName.c_str();
-    info.layout                      = m_pipelineLayout;
+    if (!constants.empty())
+        info.stage.pSpecializationInfo = &specialization;
+    info.layout = m_pipelineLayout;
     RI_CHECK_RESULT_MSG("couldn't create compute pipeline") =
-        vkCreateComputePipelines(detail::getVkHandle(device), VK_NULL_HANDLE, 1, &info, nullptr, &m_handle);
+        vkCreateComputePipelines(m_device, detail::getVkHandle(device.pipelineCache()), 1, &info, nullptr, &m_handle);
 }
 
 ComputePipeline::~ComputePipeline()
 {
     vkDestroyPipeline(m_device, m_handle, nullptr);
-    vkDestroyPipelineLayout(m_device, m_pipelineLayout, nullptr);
+    // the layout is owned by the device's pipeline layout cache
 }
 
-inline VkPipelineLayout ComputePipeline::createLayout(const VkDevice                            device,
+inline VkPipelineLayout ComputePipeline::createLayout(const ri::DeviceContext&                  device,
                                                       const std::vector<VkDescriptorSetLayout>& descriptorLayouts,
                                                       const std::vector<PushParams>&            pushConstants)
 {
-    VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
-    pipelineLayoutInfo.sType                      = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutInfo.setLayoutCount             = descriptorLayouts.size();
-    pipelineLayoutInfo.pSetLayouts                = descriptorLayouts.data();
-
     std::vector<VkPushConstantRange> ranges(pushConstants.size());
     for (size_t i = 0; i < ranges.size(); ++i)
     {
@@ -84,13 +97,7 @@ inline VkPipelineLayout ComputePipeline::createLayout(const VkDevice
         range.size            = pushParam.size;
         range.stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT;
     }
-    pipelineLayoutInfo.pushConstantRangeCount = ranges.size();
-    pipelineLayoutInfo.pPushConstantRanges    = ranges.data();
-
-    VkPipelineLayout pipelineLayout;
-    RI_CHECK_RESULT_MSG("couldn't create pipeline layout") =
-        vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout);
-    return pipelineLayout;
+    return device.pipelineLayoutCache().get(descriptorLayouts, ranges);
 }
 
 void ComputePipeline::bind(CommandBuffer& buffer, const ri::DescriptorSet& descriptor) const
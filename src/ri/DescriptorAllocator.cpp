@@ -0,0 +1,164 @@
+
+#include <ri/DescriptorAllocator.h>
+
+#include <algorithm>
+#include <ri/DescriptorSet.h>
+#include <ri/DeviceContext.h>
+#include <ri/Fence.h>
+
+namespace ri
+{
+namespace
+{
+    const uint32_t kMaxSetsPerPool = 4096;
+}
+
+DescriptorAllocator::DescriptorAllocator(const DeviceContext& device, const std::vector<TypeSize>& setSizes,
+                                         uint32_t setsPerPool /*= 64*/, uint32_t frameCount /*= 2*/)
+    : m_device(detail::getVkHandle(device))
+    , m_setSizes(setSizes)
+    , m_nextSetsPerPool(setsPerPool)
+    , m_frames(frameCount)
+    , m_frameIndex(frameCount - 1)
+{
+    assert(!setSizes.empty() && setSizes.size() <= DescriptorType::Count);
+    assert(setsPerPool);
+    assert(frameCount);
+}
+
+DescriptorAllocator::~DescriptorAllocator()
+{
+    reset();
+    for (auto pool : m_freePools)
+        vkDestroyDescriptorPool(m_device, pool, nullptr);
+}
+
+DescriptorSet DescriptorAllocator::allocate(DescriptorSetLayout layout)
+{
+    return allocate(m_pools, layout);
+}
+
+DescriptorSet DescriptorAllocator::allocate(DescriptorSetLayout layout, const DescriptorSetParams& params)
+{
+    DescriptorSet descriptor = allocate(m_pools, layout);
+    descriptor.update(params);
+    return descriptor;
+}
+
+DescriptorSet DescriptorAllocator::allocateTransient(DescriptorSetLayout layout)
+{
+    assert(m_frameActive);
+    return allocate(m_frames[m_frameIndex].pools, layout);
+}
+
+DescriptorSet DescriptorAllocator::allocateTransient(DescriptorSetLayout layout, const DescriptorSetParams& params)
+{
+    DescriptorSet descriptor = allocateTransient(layout);
+    descriptor.update(params);
+    return descriptor;
+}
+
+void DescriptorAllocator::beginFrame()
+{
+    assert(!m_frameActive);
+
+    m_frameIndex = (m_frameIndex + 1) % m_frames.size();
+    auto& frame  = m_frames[m_frameIndex];
+    if (frame.fence)
+        frame.fence->wait();
+    frame.fence = nullptr;
+
+    recycle(frame.pools);
+    m_frameActive = true;
+}
+
+void DescriptorAllocator::endFrame(const Fence* fence)
+{
+    assert(m_frameActive);
+
+    m_frames[m_frameIndex].fence = fence;
+    m_frameActive                = false;
+}
+
+void DescriptorAllocator::reset()
+{
+    for (auto& frame : m_frames)
+    {
+        if (frame.fence)
+            frame.fence->wait();
+        frame.fence = nullptr;
+        recycle(frame.pools);
+    }
+    recycle(m_pools);
+    m_frameActive = false;
+}
+
+DescriptorSet DescriptorAllocator::allocate(std::vector<VkDescriptorPool>& pools, DescriptorSetLayout layout)
+{
+    assert(layout);
+
+    VkDescriptorSetAllocateInfo allocInfo = {};
+    allocInfo.sType                       = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorSetCount          = 1;
+    allocInfo.pSetLayouts                 = &layout;
+
+    VkDescriptorSet handle = VK_NULL_HANDLE;
+    if (!pools.empty())
+    {
+        allocInfo.descriptorPool = pools.back();
+        const VkResult res       = vkAllocateDescriptorSets(m_device, &allocInfo, &handle);
+        if (res == VK_SUCCESS)
+            return DescriptorSet(m_device, handle);
+    }
+
+    // the current pool is exhausted, chain a new one and retry once
+    // any failure is treated as exhaustion, drivers without VK_KHR_maintenance1 may report out of device memory
+    pools.push_back(acquirePool());
+    allocInfo.descriptorPool = pools.back();
+    RI_CHECK_RESULT_MSG("couldn't allocate descriptor sets") = vkAllocateDescriptorSets(m_device, &allocInfo, &handle);
+
+    return DescriptorSet(m_device, handle);
+}
+
+VkDescriptorPool DescriptorAllocator::acquirePool()
+{
+    if (!m_freePools.empty())
+    {
+        VkDescriptorPool pool = m_freePools.back();
+        m_freePools.pop_back();
+        return pool;
+    }
+
+    const uint32_t setCount = m_nextSetsPerPool;
+    m_nextSetsPerPool       = std::min(m_nextSetsPerPool * 2, kMaxSetsPerPool);
+
+    std::vector<VkDescriptorPoolSize> poolSizes(m_setSizes.size());
+    for (size_t i = 0; i < m_setSizes.size(); ++i)
+    {
+        poolSizes[i].type            = (VkDescriptorType)m_setSizes[i].first;
+        poolSizes[i].descriptorCount = m_setSizes[i].second * setCount;
+    }
+
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType                      = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount              = poolSizes.size();
+    poolInfo.pPoolSizes                 = poolSizes.data();
+    poolInfo.maxSets                    = setCount;
+
+    VkDescriptorPool pool;
+    RI_CHECK_RESULT_MSG("couldn't create descriptor pool") =
+        vkCreateDescriptorPool(m_device, &poolInfo, nullptr, &pool);
+    ++m_poolCount;
+    return pool;
+}
+
+void DescriptorAllocator::recycle(std::vector<VkDescriptorPool>& pools)
+{
+    // frees all the pool's sets at once
+    for (auto pool : pools)
+        vkResetDescriptorPool(m_device, pool, 0);
+    m_freePools.insert(m_freePools.end(), pools.begin(), pools.end());
+    pools.clear();
+}
+
+}  // namespace ri
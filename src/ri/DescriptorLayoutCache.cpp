@@ -0,0 +1,114 @@
+
+#include <ri/DescriptorLayoutCache.h>
+
+#include <algorithm>
+
+namespace ri
+{
+namespace
+{
+    inline void hashCombine(size_t& seed, size_t value)
+    {
+        seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    }
+}  // namespace
+
+DescriptorLayoutCache::DescriptorLayoutCache(VkDevice device)
+    : m_device(device)
+{
+    assert(device);
+}
+
+DescriptorLayoutCache::~DescriptorLayoutCache()
+{
+    for (const auto& bucket : m_layouts)
+    {
+        for (const auto& entry : bucket.second)
+            vkDestroyDescriptorSetLayout(m_device, entry.layout, nullptr);
+    }
+}
+
+DescriptorSetLayout DescriptorLayoutCache::get(const DescriptorLayoutParam& param)
+{
+    std::vector<DescriptorBinding> bindings = sortedBindings(param);
+    const size_t                   seed     = hashBindings(bindings, param.flags);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto& bucket = m_layouts[seed];
+    for (const auto& entry : bucket)
+    {
+        if (entry.flags == param.flags && equal(entry.bindings, bindings))
+            return entry.layout;
+    }
+
+    std::vector<VkDescriptorSetLayoutBinding> bindingInfos(bindings.size());
+    for (size_t i = 0; i < bindings.size(); ++i)
+    {
+        const auto& binding            = bindings[i];
+        auto&       bindingInfo        = bindingInfos[i];
+        bindingInfo.binding            = binding.index;
+        bindingInfo.descriptorCount    = binding.count;
+        bindingInfo.descriptorType     = (VkDescriptorType)binding.type;
+        bindingInfo.stageFlags         = (VkShaderStageFlags)binding.stageFlags;
+        bindingInfo.pImmutableSamplers = nullptr;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+    layoutInfo.sType                           = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.flags                           = (VkDescriptorSetLayoutCreateFlags)param.flags;
+    layoutInfo.bindingCount                    = bindingInfos.size();
+    layoutInfo.pBindings                       = bindingInfos.data();
+
+    VkDescriptorSetLayout layout;
+    RI_CHECK_RESULT_MSG("couldn't create descriptor set layout") =
+        vkCreateDescriptorSetLayout(m_device, &layoutInfo, nullptr, &layout);
+
+    bucket.push_back(Entry({std::move(bindings), param.flags, layout}));
+    ++m_layoutCount;
+    return layout;
+}
+
+size_t DescriptorLayoutCache::hash(const DescriptorLayoutParam& param)
+{
+    return hashBindings(sortedBindings(param), param.flags);
+}
+
+std::vector<DescriptorBinding> DescriptorLayoutCache::sortedBindings(const DescriptorLayoutParam& param)
+{
+    std::vector<DescriptorBinding> bindings = param.bindings;
+    std::sort(bindings.begin(), bindings.end(),
+              [](const DescriptorBinding& lhs, const DescriptorBinding& rhs) { return lhs.index < rhs.index; });
+    return bindings;
+}
+
+size_t DescriptorLayoutCache::hashBindings(const std::vector<DescriptorBinding>& bindings,
+                                           DescriptorLayoutParam::FlagType       flags)
+{
+    size_t seed = bindings.size();
+    hashCombine(seed, flags);
+    for (const auto& binding : bindings)
+    {
+        hashCombine(seed, binding.index);
+        hashCombine(seed, binding.stageFlags);
+        hashCombine(seed, binding.type.get());
+        hashCombine(seed, binding.count);
+    }
+    return seed;
+}
+
+bool DescriptorLayoutCache::equal(const std::vector<DescriptorBinding>& lhs, const std::vector<DescriptorBinding>& rhs)
+{
+    if (lhs.size() != rhs.size())
+        return false;
+
+    for (size_t i = 0; i < lhs.size(); ++i)
+    {
+        if (lhs[i].index != rhs[i].index || lhs[i].stageFlags != rhs[i].stageFlags || lhs[i].type != rhs[i].type ||
+            lhs[i].count != rhs[i].count)
+            return false;
+    }
+    return true;
+}
+
+}  // namespace ri
@@ -1,13 +1,17 @@
 
-#include <array>
 #include <ri/DescriptorPool.h>
+
+#include <array>
+#include <ri/DescriptorLayoutCache.h>
 #include <ri/DescriptorSet.h>
+#include <ri/DeviceContext.h>
 
 namespace ri
 {
 DescriptorPool::DescriptorPool(const DeviceContext& device, size_t poolSetSize, DescriptorType type, size_t maxCount,
                                FlagType flags /*= eNone*/)
     : m_device(ri::detail::getVkHandle(device))
+    , m_layoutCache(&device.descriptorLayoutCache())
 {
     VkDescriptorPoolSize poolSize = {};
     poolSize.type                 = (VkDescriptorType)type;
@@ -27,6 +31,7 @@ DescriptorPool::DescriptorPool(const DeviceContext& device, size_t poolSetSize,
 DescriptorPool::DescriptorPool(const DeviceContext& device, size_t poolSetSize, const TypeSize* availableDescriptors,
                                size_t availableDescriptorsCount, FlagType flags /*= eNone*/)
     : m_device(ri::detail::getVkHandle(device))
+    , m_layoutCache(&device.descriptorLayoutCache())
 {
     assert(availableDescriptors);
     std::array<VkDescriptorPoolSize, DescriptorType::Count> poolSizes;
@@ -51,10 +56,6 @@ DescriptorPool::DescriptorPool(const DeviceContext& device, size_t poolSetSize,
 
 DescriptorPool::~DescriptorPool()
 {
-    for (const auto& descriptorSetLayout : m_descriptorLayouts)
-    {
-        vkDestroyDescriptorSetLayout(m_device, descriptorSetLayout, nullptr);
-    }
     vkDestroyDescriptorPool(m_device, m_handle, nullptr);
 }
 
@@ -78,7 +79,7 @@ DescriptorSet DescriptorPool::create(uint32_t layoutIndex)
 DescriptorSet DescriptorPool::create(uint32_t layoutIndex, const DescriptorSetParams& params)
 {
     DescriptorSet descriptor = create(layoutIndex);
-    descriptor.update<16>(params);
+    descriptor.update(params);
     return descriptor;
 }
 
@@ -128,29 +129,7 @@ void DescriptorPool::free(const DescriptorSet* descriptors, uint32_t count)
 
 DescriptorPool::CreateLayoutResult DescriptorPool::createLayout(const DescriptorLayoutParam& descriptorParams)
 {
-    std::vector<VkDescriptorSetLayoutBinding> bindingInfos;
-
-    for (const auto& binding : descriptorParams.bindings)
-    {
-        bindingInfos.emplace_back();
-        auto& bindingInfo              = bindingInfos.back();
-        bindingInfo.binding            = binding.index;
-        bindingInfo.descriptorCount    = 1;
-        bindingInfo.descriptorType     = (VkDescriptorType)binding.type;
-        bindingInfo.stageFlags         = (VkShaderStageFlags)binding.stageFlags;
-        bindingInfo.pImmutableSamplers = nullptr;
-    }
-
-    VkDescriptorSetLayoutCreateInfo layoutInfo = {};
-    layoutInfo.sType                           = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-    layoutInfo.bindingCount                    = bindingInfos.size();
-    layoutInfo.pBindings                       = bindingInfos.data();
-
-    m_descriptorLayouts.emplace_back();
-    auto& descriptorSetLayout = m_descriptorLayouts.back();
-    RI_CHECK_RESULT_MSG("couldn't create descriptor set layout") =
-        vkCreateDescriptorSetLayout(m_device, &layoutInfo, nullptr, &descriptorSetLayout);
-
+    m_descriptorLayouts.push_back(m_layoutCache->get(descriptorParams));
     return CreateLayoutResult({m_descriptorLayouts.back(), m_descriptorLayouts.size() - 1});
 }
 
@@ -159,34 +138,8 @@ size_t DescriptorPool::createLayouts(const DescriptorLayoutParam* layoutParams,
     assert(layoutParams);
 
     size_t startIndex = m_descriptorLayouts.size();
-
-    std::vector<VkDescriptorSetLayout>        descriptors(layoutParamsCount);
-    std::vector<VkDescriptorSetLayoutBinding> bindingInfos;
     for (size_t i = 0; i < layoutParamsCount; ++i)
-    {
-        const auto& descriptorParams = layoutParams[i];
-        for (const auto& binding : descriptorParams.bindings)
-        {
-            bindingInfos.emplace_back();
-            auto& bindingInfo              = bindingInfos.back();
-            bindingInfo.binding            = binding.index;
-            bindingInfo.descriptorCount    = 1;
-            bindingInfo.descriptorType     = (VkDescriptorType)binding.type;
-            bindingInfo.stageFlags         = (VkShaderStageFlags)binding.stageFlags;
-            bindingInfo.pImmutableSamplers = nullptr;
-        }
-
-        VkDescriptorSetLayoutCreateInfo layoutInfo = {};
-        layoutInfo.sType                           = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-        layoutInfo.bindingCount                    = bindingInfos.size();
-        layoutInfo.pBindings                       = bindingInfos.data();
-
-        auto& descriptorSetLayout = descriptors[i];
-        RI_CHECK_RESULT_MSG("couldn't create descriptor set layouts") =
-            vkCreateDescriptorSetLayout(m_device, &layoutInfo, nullptr, &descriptorSetLayout);
-    }
-
-    m_descriptorLayouts.insert(m_descriptorLayouts.end(), descriptors.begin(), descriptors.end());
+        m_descriptorLayouts.push_back(m_layoutCache->get(layoutParams[i]));
     return startIndex;
 }
 
@@ -0,0 +1,141 @@
+
+#include <ri/DescriptorUpdateTemplate.h>
+
+#include <ri/Buffer.h>
+#include <ri/BufferView.h>
+#include <ri/DescriptorLayoutCache.h>
+#include <ri/DescriptorSet.h>
+#include <ri/DeviceContext.h>
+#include <ri/Texture.h>
+
+namespace ri
+{
+DescriptorUpdateTemplate::Entry::Entry()
+{
+    image = VkDescriptorImageInfo();
+}
+
+DescriptorUpdateTemplate::Entry::Entry(const Buffer& buffer, size_t offset /*= 0*/, size_t size /*= VK_WHOLE_SIZE*/)
+{
+    this->buffer.buffer = detail::getVkHandle(buffer);
+    this->buffer.offset = offset;
+    this->buffer.range  = size;
+}
+
+DescriptorUpdateTemplate::Entry::Entry(const Texture& texture,
+                                       DescriptorType type /*= DescriptorType::eCombinedSampler*/)
+{
+    const auto& textureInfo = detail::getTextureDescriptorInfo(texture);
+    image.imageView         = textureInfo.imageView;
+    image.imageLayout       = textureInfo.layout;
+    if (type == DescriptorType::eSampledImage || type == DescriptorType::eCombinedSampler)
+        image.sampler = textureInfo.sampler;
+    else
+        image.sampler = VK_NULL_HANDLE;
+}
+
+DescriptorUpdateTemplate::Entry::Entry(const BufferView& bufferView)
+{
+    image       = VkDescriptorImageInfo();
+    texelBuffer = detail::getVkHandle(bufferView);
+}
+
+DescriptorUpdateTemplate::DescriptorUpdateTemplate(const DeviceContext& device, const DescriptorLayoutParam& param)
+    : m_device(detail::getVkHandle(device))
+    , m_functions(&detail::getDeviceFunctions(device))
+    , m_layout(device.descriptorLayoutCache().get(param))
+    , m_entryCount(0)
+{
+    assert(!param.bindings.empty());
+
+    // the entries are tightly packed, one per array element
+    std::vector<VkDescriptorUpdateTemplateEntryKHR> entries(param.bindings.size());
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        const auto& binding   = param.bindings[i];
+        auto&       entry     = entries[i];
+        entry.dstBinding      = binding.index;
+        entry.dstArrayElement = 0;
+        entry.descriptorCount = binding.count;
+        entry.descriptorType  = (VkDescriptorType)binding.type;
+        entry.offset          = m_entryCount * sizeof(Entry);
+        entry.stride          = sizeof(Entry);
+        m_entryCount += binding.count;
+    }
+
+    if (!device.featureEnabled(DeviceFeature::eDescriptorUpdateTemplate))
+    {
+        m_entries = std::move(entries);
+        return;
+    }
+    assert(m_functions->createDescriptorUpdateTemplate);
+
+    VkDescriptorUpdateTemplateCreateInfoKHR templateInfo = {};
+    templateInfo.sType                                   = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO_KHR;
+    templateInfo.descriptorUpdateEntryCount              = entries.size();
+    templateInfo.pDescriptorUpdateEntries                = entries.data();
+    templateInfo.templateType                            = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET_KHR;
+    templateInfo.descriptorSetLayout                     = m_layout;
+
+    RI_CHECK_RESULT_MSG("couldn't create descriptor update template") =
+        m_functions->createDescriptorUpdateTemplate(m_device, &templateInfo, nullptr, &m_handle);
+}
+
+DescriptorUpdateTemplate::~DescriptorUpdateTemplate()
+{
+    if (m_handle)
+        m_functions->destroyDescriptorUpdateTemplate(m_device, m_handle, nullptr);
+}
+
+void DescriptorUpdateTemplate::update(const DescriptorSet& descriptor, const Entry* entries) const
+{
+    assert(entries);
+    if (m_handle)
+    {
+        m_functions->updateDescriptorSetWithTemplate(m_device, detail::getVkHandle(descriptor), m_handle, entries);
+        return;
+    }
+
+    // the buffer and image infos have the stride of the entries, the writes point into them
+    static_assert(sizeof(Entry) == sizeof(VkDescriptorBufferInfo) && sizeof(Entry) == sizeof(VkDescriptorImageInfo),
+                  "INVALID_SIZE");
+    std::vector<VkWriteDescriptorSet> writes;
+    writes.reserve(m_entries.size());
+    for (const auto& entry : m_entries)
+    {
+        const Entry*         infos = entries + entry.offset / sizeof(Entry);
+        VkWriteDescriptorSet write = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+        write.dstSet               = detail::getVkHandle(descriptor);
+        write.dstBinding           = entry.dstBinding;
+        write.dstArrayElement      = entry.dstArrayElement;
+        write.descriptorCount      = entry.descriptorCount;
+        write.descriptorType       = entry.descriptorType;
+        switch (entry.descriptorType)
+        {
+            case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+            case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+                // the views are narrower than the entries, one write per array element
+                write.descriptorCount = 1;
+                for (uint32_t i = 0; i < entry.descriptorCount; ++i)
+                {
+                    write.dstArrayElement  = entry.dstArrayElement + i;
+                    write.pTexelBufferView = &infos[i].texelBuffer;
+                    writes.push_back(write);
+                }
+                continue;
+            case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+            case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+            case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+            case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
+                write.pBufferInfo = &infos->buffer;
+                break;
+            default:
+                write.pImageInfo = &infos->image;
+                break;
+        }
+        writes.push_back(write);
+    }
+    vkUpdateDescriptorSets(m_device, writes.size(), writes.data(), 0, nullptr);
+}
+
+}  // namespace ri
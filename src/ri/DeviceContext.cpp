@@ -7,7 +7,12 @@
 #include <unordered_set>
 #include <util/common.h>
 #include <util/iterator.h>
+#include <ri/ApplicationInstance.h>
 #include <ri/CommandPool.h>
+#include <ri/DescriptorLayoutCache.h>
+#include <ri/PipelineCache.h>
+#include <ri/PipelineLayoutCache.h>
+#include <ri/ShaderModuleCache.h>
 #include <ri/ValidationReport.h>
 
 namespace ri
@@ -15,7 +20,10 @@ namespace ri
 namespace
 {
     const std::unordered_map<DeviceFeature, const char*> kDeviceStringMap = {
-        {DeviceFeature::eSwapchain, VK_KHR_SWAPCHAIN_EXTENSION_NAME}};
+        {DeviceFeature::eSwapchain, VK_KHR_SWAPCHAIN_EXTENSION_NAME},
+        {DeviceFeature::eDrawIndirectCount, VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME},
+        {DeviceFeature::eDescriptorUpdateTemplate, VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME},
+        {DeviceFeature::ePushDescriptor, VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME}};
 
     int getFlagFrom(DeviceOperation type)
     {
@@ -33,13 +41,53 @@ namespace
         return 0;
     }
 
-    std::pair<VkPhysicalDeviceFeatures, std::vector<const char*> > getDevicesFeatures(
-        const std::vector<DeviceFeature>& requiredFeatures)
+    struct DeviceFeatures
     {
-        std::pair<VkPhysicalDeviceFeatures, std::vector<const char*> > result;
-
-        auto& deviceFeatures = result.first;
-        auto& extensionNames = result.second;
+        VkPhysicalDeviceFeatures features = {};
+        std::vector<const char*> extensions;
+        // extension features, chained to the device create info
+        VkPhysicalDeviceDescriptorIndexingFeaturesEXT descriptorIndexing = {
+            VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT};
+        VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT pipelineLibrary = {
+            VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT};
+        VkPhysicalDeviceExtendedDynamicStateFeaturesEXT extendedDynamicState = {
+            VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_FEATURES_EXT};
+        VkPhysicalDeviceExtendedDynamicState2FeaturesEXT extendedDynamicState2 = {
+            VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_2_FEATURES_EXT};
+        VkPhysicalDeviceExtendedDynamicState3FeaturesEXT extendedDynamicState3 = {
+            VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT};
+        void* next = nullptr;
+
+        template <typename FeatureStruct>
+        void chain(FeatureStruct& features)
+        {
+            // a struct may be required by several features
+            for (auto it = static_cast<const VkBaseOutStructure*>(next); it; it = it->pNext)
+            {
+                if (it == static_cast<const void*>(&features))
+                    return;
+            }
+            features.pNext = next;
+            next           = &features;
+        }
+    };
+
+    // the descriptor indexing features used by the bindless tables
+    VkBool32 VkPhysicalDeviceDescriptorIndexingFeaturesEXT::*const kDescriptorIndexingBits[] = {
+        &VkPhysicalDeviceDescriptorIndexingFeaturesEXT::shaderSampledImageArrayNonUniformIndexing,
+        &VkPhysicalDeviceDescriptorIndexingFeaturesEXT::shaderStorageBufferArrayNonUniformIndexing,
+        &VkPhysicalDeviceDescriptorIndexingFeaturesEXT::descriptorBindingSampledImageUpdateAfterBind,
+        &VkPhysicalDeviceDescriptorIndexingFeaturesEXT::descriptorBindingStorageBufferUpdateAfterBind,
+        &VkPhysicalDeviceDescriptorIndexingFeaturesEXT::descriptorBindingUpdateUnusedWhilePending,
+        &VkPhysicalDeviceDescriptorIndexingFeaturesEXT::descriptorBindingPartiallyBound,
+        &VkPhysicalDeviceDescriptorIndexingFeaturesEXT::runtimeDescriptorArray};
+
+    /// Fills the features to enable, the optional bits are only enabled if they're supported.
+    void getDevicesFeatures(const std::vector<DeviceFeature>& requiredFeatures, const DeviceFeatures& supported,
+                            DeviceFeatures& result)
+    {
+        auto& deviceFeatures = result.features;
+        auto& extensionNames = result.extensions;
         for (auto feature : requiredFeatures)
         {
             switch (feature.get())
@@ -62,6 +110,63 @@ namespace
                 case DeviceFeature::eSampleRateShading:
                     deviceFeatures.sampleRateShading = VK_TRUE;
                     break;
+                case DeviceFeature::ePipelineStatistics:
+                    deviceFeatures.pipelineStatisticsQuery = VK_TRUE;
+                    break;
+                case DeviceFeature::eOcclusionPrecise:
+                    deviceFeatures.occlusionQueryPrecise = VK_TRUE;
+                    break;
+                case DeviceFeature::eMultiDrawIndirect:
+                    deviceFeatures.multiDrawIndirect         = VK_TRUE;
+                    deviceFeatures.drawIndirectFirstInstance = VK_TRUE;
+                    break;
+                case DeviceFeature::eDescriptorIndexing:
+                {
+                    for (auto bit : kDescriptorIndexingBits)
+                        result.descriptorIndexing.*bit = VK_TRUE;
+                    result.chain(result.descriptorIndexing);
+                    extensionNames.push_back(VK_KHR_MAINTENANCE3_EXTENSION_NAME);
+                    extensionNames.push_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+                    break;
+                }
+                case DeviceFeature::eGraphicsPipelineLibrary:
+                {
+                    result.pipelineLibrary.graphicsPipelineLibrary = VK_TRUE;
+                    result.chain(result.pipelineLibrary);
+                    extensionNames.push_back(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME);
+                    extensionNames.push_back(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+                    break;
+                }
+                case DeviceFeature::eExtendedDynamicState:
+                {
+                    result.extendedDynamicState.extendedDynamicState = VK_TRUE;
+                    result.chain(result.extendedDynamicState);
+                    extensionNames.push_back(VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME);
+
+                    // optional, see DeviceContext::supportsDynamicState
+                    const auto& supported2 = supported.extendedDynamicState2;
+                    if (!supported2.extendedDynamicState2)
+                        break;
+                    auto& state2                                   = result.extendedDynamicState2;
+                    state2.extendedDynamicState2                   = VK_TRUE;
+                    state2.extendedDynamicState2PatchControlPoints = supported2.extendedDynamicState2PatchControlPoints;
+                    result.chain(state2);
+                    extensionNames.push_back(VK_EXT_EXTENDED_DYNAMIC_STATE_2_EXTENSION_NAME);
+                    break;
+                }
+                case DeviceFeature::eExtendedDynamicState3:
+                {
+                    // all the bits are optional
+                    const auto& supported3                       = supported.extendedDynamicState3;
+                    auto&       state3                           = result.extendedDynamicState3;
+                    state3.extendedDynamicState3PolygonMode      = supported3.extendedDynamicState3PolygonMode;
+                    state3.extendedDynamicState3DepthClampEnable = supported3.extendedDynamicState3DepthClampEnable;
+                    state3.extendedDynamicState3ColorBlendEnable = supported3.extendedDynamicState3ColorBlendEnable;
+                    state3.extendedDynamicState3ColorWriteMask   = supported3.extendedDynamicState3ColorWriteMask;
+                    result.chain(state3);
+                    extensionNames.push_back(VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME);
+                    break;
+                }
                 default:
                     auto found = kDeviceStringMap.find(feature);
                     assert(found != kDeviceStringMap.end());
@@ -69,7 +174,236 @@ namespace
                     break;
             }
         }
-        return result;
+    }
+
+    bool hasExtension(const std::vector<VkExtensionProperties>& availableExtensions, const char* extensionName)
+    {
+        return std::find_if(availableExtensions.begin(), availableExtensions.end(),
+                            [extensionName](const VkExtensionProperties& e) {
+                                return std::string(e.extensionName) == extensionName;
+                            }) != availableExtensions.end();
+    }
+
+    std::vector<VkExtensionProperties> getDeviceExtensions(VkPhysicalDevice device)
+    {
+        uint32_t extensionCount;
+        vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+        std::vector<VkExtensionProperties> extensions(extensionCount);
+        vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, extensions.data());
+        return extensions;
+    }
+
+    /// Queries the extension features of the required features.
+    ///@note A feature struct is left zeroed if its extension or the instance's properties2 extension is missing.
+    void querySupportedFeatures(const ApplicationInstance& instance, VkPhysicalDevice device,
+                                const std::vector<VkExtensionProperties>& availableExtensions,
+                                const std::vector<DeviceFeature>& requiredFeatures, DeviceFeatures& result)
+    {
+        vkGetPhysicalDeviceFeatures(device, &result.features);
+        if (!instance.extensionEnabled(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME))
+            return;
+
+        for (auto feature : requiredFeatures)
+        {
+            switch (feature.get())
+            {
+                case DeviceFeature::eDescriptorIndexing:
+                    if (hasExtension(availableExtensions, VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME))
+                        result.chain(result.descriptorIndexing);
+                    break;
+                case DeviceFeature::eGraphicsPipelineLibrary:
+                    if (hasExtension(availableExtensions, VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME))
+                        result.chain(result.pipelineLibrary);
+                    break;
+                case DeviceFeature::eExtendedDynamicState:
+                    if (hasExtension(availableExtensions, VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME))
+                        result.chain(result.extendedDynamicState);
+                    if (hasExtension(availableExtensions, VK_EXT_EXTENDED_DYNAMIC_STATE_2_EXTENSION_NAME))
+                        result.chain(result.extendedDynamicState2);
+                    break;
+                case DeviceFeature::eExtendedDynamicState3:
+                    if (hasExtension(availableExtensions, VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME))
+                        result.chain(result.extendedDynamicState3);
+                    break;
+                default:
+                    break;
+            }
+        }
+        if (!result.next)
+            return;
+
+        auto getFeatures2 = (PFN_vkGetPhysicalDeviceFeatures2KHR)vkGetInstanceProcAddr(
+            detail::getVkHandle(instance), "vkGetPhysicalDeviceFeatures2KHR");
+        assert(getFeatures2);
+
+        VkPhysicalDeviceFeatures2KHR features2 = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR};
+        features2.pNext                        = result.next;
+        getFeatures2(device, &features2);
+    }
+
+    /// @return true if the device supports the feature.
+    bool hasFeature(const ApplicationInstance& instance, const std::vector<VkExtensionProperties>& availableExtensions,
+                    const DeviceFeatures& supported, DeviceFeature feature)
+    {
+        const VkPhysicalDeviceFeatures& deviceFeatures = supported.features;
+
+        bool has = true;
+        switch (feature.get())
+        {
+            case DeviceFeature::eGeometryShader:
+                has &= deviceFeatures.geometryShader == VK_TRUE;
+                break;
+            case DeviceFeature::eTesselationShader:
+                has &= deviceFeatures.tessellationShader == VK_TRUE;
+                break;
+            case DeviceFeature::eFloat64:
+                has &= deviceFeatures.shaderFloat64 == VK_TRUE;
+                break;
+            case DeviceFeature::eAnisotropy:
+                has &= deviceFeatures.samplerAnisotropy == VK_TRUE;
+                break;
+            case DeviceFeature::eWireframe:
+                has &= deviceFeatures.fillModeNonSolid == VK_TRUE;
+                break;
+            case DeviceFeature::eSampleRateShading:
+                has &= deviceFeatures.sampleRateShading == VK_TRUE;
+                break;
+            case DeviceFeature::ePipelineStatistics:
+                has &= deviceFeatures.pipelineStatisticsQuery == VK_TRUE;
+                break;
+            case DeviceFeature::eOcclusionPrecise:
+                has &= deviceFeatures.occlusionQueryPrecise == VK_TRUE;
+                break;
+            case DeviceFeature::eMultiDrawIndirect:
+                has &= deviceFeatures.multiDrawIndirect == VK_TRUE;
+                has &= deviceFeatures.drawIndirectFirstInstance == VK_TRUE;
+                break;
+            case DeviceFeature::eDescriptorIndexing:
+                has &= hasExtension(availableExtensions, VK_KHR_MAINTENANCE3_EXTENSION_NAME);
+                for (auto bit : kDescriptorIndexingBits)
+                    has &= supported.descriptorIndexing.*bit == VK_TRUE;
+                break;
+            case DeviceFeature::ePushDescriptor:
+                has &= instance.extensionEnabled(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+                has &= hasExtension(availableExtensions, VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME);
+                break;
+            case DeviceFeature::eGraphicsPipelineLibrary:
+                has &= hasExtension(availableExtensions, VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME);
+                has &= supported.pipelineLibrary.graphicsPipelineLibrary == VK_TRUE;
+                break;
+            case DeviceFeature::eExtendedDynamicState:
+                // the extended dynamic state 2 is optional, see DeviceContext::supportsDynamicState
+                has &= supported.extendedDynamicState.extendedDynamicState == VK_TRUE;
+                break;
+            case DeviceFeature::eExtendedDynamicState3:
+                // the states are optional, see DeviceContext::supportsDynamicState
+                has &= instance.extensionEnabled(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+                has &= hasExtension(availableExtensions, VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME);
+                break;
+            default:
+                auto found = kDeviceStringMap.find(feature);
+                assert(found != kDeviceStringMap.end());
+                has &= hasExtension(availableExtensions, found->second);
+                break;
+        }
+        return has;
+    }
+
+    /// @return The maxPushDescriptors limit of the device.
+    uint32_t queryMaxPushDescriptors(const ApplicationInstance& instance, VkPhysicalDevice device)
+    {
+        auto getProperties2 = (PFN_vkGetPhysicalDeviceProperties2KHR)vkGetInstanceProcAddr(
+            detail::getVkHandle(instance), "vkGetPhysicalDeviceProperties2KHR");
+        assert(getProperties2);
+
+        VkPhysicalDevicePushDescriptorPropertiesKHR pushDescriptorProperties = {
+            VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PUSH_DESCRIPTOR_PROPERTIES_KHR};
+        VkPhysicalDeviceProperties2KHR properties2 = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2_KHR};
+        properties2.pNext                          = &pushDescriptorProperties;
+        getProperties2(device, &properties2);
+        return pushDescriptorProperties.maxPushDescriptors;
+    }
+
+    /// @return The extended dynamic states of the enabled features.
+    std::vector<DynamicState> getExtendedDynamicStates(const DeviceFeatures& enabled)
+    {
+        std::vector<DynamicState> states;
+        if (enabled.extendedDynamicState.extendedDynamicState)
+        {
+            states.insert(states.end(),
+                          {DynamicState::eCullMode, DynamicState::eFrontFace, DynamicState::ePrimitiveTopology,
+                           DynamicState::eDepthTestEnable, DynamicState::eDepthWriteEnable,
+                           DynamicState::eDepthCompareOp, DynamicState::eDepthBoundsTestEnable,
+                           DynamicState::eStencilTestEnable, DynamicState::eStencilOp});
+        }
+        const auto& state2 = enabled.extendedDynamicState2;
+        if (state2.extendedDynamicState2)
+        {
+            states.insert(states.end(), {DynamicState::eRasterizerDiscardEnable, DynamicState::eDepthBiasEnable,
+                                         DynamicState::ePrimitiveRestartEnable});
+        }
+        if (state2.extendedDynamicState2PatchControlPoints)
+            states.push_back(DynamicState::ePatchControlPoints);
+        const auto& state3 = enabled.extendedDynamicState3;
+        if (state3.extendedDynamicState3PolygonMode)
+            states.push_back(DynamicState::ePolygonMode);
+        if (state3.extendedDynamicState3DepthClampEnable)
+            states.push_back(DynamicState::eDepthClampEnable);
+        if (state3.extendedDynamicState3ColorBlendEnable)
+            states.push_back(DynamicState::eColorBlendEnable);
+        if (state3.extendedDynamicState3ColorWriteMask)
+            states.push_back(DynamicState::eColorWriteMask);
+        return states;
+    }
+
+    void loadDeviceFunctions(VkDevice device, detail::DeviceFunctions& functions)
+    {
+        functions.cmdDrawIndirectCount =
+            (PFN_vkCmdDrawIndirectCountKHR)vkGetDeviceProcAddr(device, "vkCmdDrawIndirectCountKHR");
+        functions.cmdDrawIndexedIndirectCount =
+            (PFN_vkCmdDrawIndexedIndirectCountKHR)vkGetDeviceProcAddr(device, "vkCmdDrawIndexedIndirectCountKHR");
+        functions.createDescriptorUpdateTemplate = (PFN_vkCreateDescriptorUpdateTemplateKHR)vkGetDeviceProcAddr(
+            device, "vkCreateDescriptorUpdateTemplateKHR");
+        functions.destroyDescriptorUpdateTemplate = (PFN_vkDestroyDescriptorUpdateTemplateKHR)vkGetDeviceProcAddr(
+            device, "vkDestroyDescriptorUpdateTemplateKHR");
+        functions.updateDescriptorSetWithTemplate = (PFN_vkUpdateDescriptorSetWithTemplateKHR)vkGetDeviceProcAddr(
+            device, "vkUpdateDescriptorSetWithTemplateKHR");
+        functions.cmdPushDescriptorSet =
+            (PFN_vkCmdPushDescriptorSetKHR)vkGetDeviceProcAddr(device, "vkCmdPushDescriptorSetKHR");
+
+        // VK_EXT_extended_dynamic_state
+        functions.cmdSetCullMode = (PFN_vkCmdSetCullModeEXT)vkGetDeviceProcAddr(device, "vkCmdSetCullModeEXT");
+        functions.cmdSetFrontFace = (PFN_vkCmdSetFrontFaceEXT)vkGetDeviceProcAddr(device, "vkCmdSetFrontFaceEXT");
+        functions.cmdSetPrimitiveTopology =
+            (PFN_vkCmdSetPrimitiveTopologyEXT)vkGetDeviceProcAddr(device, "vkCmdSetPrimitiveTopologyEXT");
+        functions.cmdSetDepthTestEnable =
+            (PFN_vkCmdSetDepthTestEnableEXT)vkGetDeviceProcAddr(device, "vkCmdSetDepthTestEnableEXT");
+        functions.cmdSetDepthWriteEnable =
+            (PFN_vkCmdSetDepthWriteEnableEXT)vkGetDeviceProcAddr(device, "vkCmdSetDepthWriteEnableEXT");
+        functions.cmdSetDepthCompareOp =
+            (PFN_vkCmdSetDepthCompareOpEXT)vkGetDeviceProcAddr(device, "vkCmdSetDepthCompareOpEXT");
+        functions.cmdSetDepthBoundsTestEnable =
+            (PFN_vkCmdSetDepthBoundsTestEnableEXT)vkGetDeviceProcAddr(device, "vkCmdSetDepthBoundsTestEnableEXT");
+        functions.cmdSetStencilTestEnable =
+            (PFN_vkCmdSetStencilTestEnableEXT)vkGetDeviceProcAddr(device, "vkCmdSetStencilTestEnableEXT");
+        functions.cmdSetStencilOp = (PFN_vkCmdSetStencilOpEXT)vkGetDeviceProcAddr(device, "vkCmdSetStencilOpEXT");
+        // VK_EXT_extended_dynamic_state2
+        functions.cmdSetRasterizerDiscardEnable =
+            (PFN_vkCmdSetRasterizerDiscardEnableEXT)vkGetDeviceProcAddr(device, "vkCmdSetRasterizerDiscardEnableEXT");
+        functions.cmdSetDepthBiasEnable =
+            (PFN_vkCmdSetDepthBiasEnableEXT)vkGetDeviceProcAddr(device, "vkCmdSetDepthBiasEnableEXT");
+        functions.cmdSetPrimitiveRestartEnable =
+            (PFN_vkCmdSetPrimitiveRestartEnableEXT)vkGetDeviceProcAddr(device, "vkCmdSetPrimitiveRestartEnableEXT");
+        functions.cmdSetPatchControlPoints =
+            (PFN_vkCmdSetPatchControlPointsEXT)vkGetDeviceProcAddr(device, "vkCmdSetPatchControlPointsEXT");
+        // VK_EXT_extended_dynamic_state3
+        functions.cmdSetPolygonMode = (PFN_vkCmdSetPolygonModeEXT)vkGetDeviceProcAddr(device, "vkCmdSetPolygonModeEXT");
+        functions.cmdSetDepthClampEnable =
+            (PFN_vkCmdSetDepthClampEnableEXT)vkGetDeviceProcAddr(device, "vkCmdSetDepthClampEnableEXT");
+        functions.cmdSetColorBlendEnable =
+            (PFN_vkCmdSetColorBlendEnableEXT)vkGetDeviceProcAddr(device, "vkCmdSetColorBlendEnableEXT");
+        functions.cmdSetColorWriteMask =
+            (PFN_vkCmdSetColorWriteMaskEXT)vkGetDeviceProcAddr(device, "vkCmdSetColorWriteMaskEXT");
     }
 }  // namespace
 
@@ -83,13 +417,18 @@ DeviceContext::~DeviceContext()
 {
     for (auto commandPool : m_commandPools)
         delete commandPool;
+    delete m_shaderModuleCache;
+    delete m_pipelineLayoutCache;
+    delete m_descriptorLayoutCache;
+    delete m_pipelineCache;
     vkDestroyDevice(m_handle, nullptr);
 }
 
 void DeviceContext::initialize(const std::vector<Surface*>&        surfaces,
                                const std::vector<DeviceFeature>&   requiredFeatures,
                                const std::vector<DeviceOperation>& requiredOperations,
-                               const CommandPoolParam&             commandParam /*= CommandPoolParam()*/)
+                               const CommandPoolParam&             commandParam /*= CommandPoolParam()*/,
+                               const std::vector<DeviceFeature>&   optionalFeatures /*= {}*/)
 {
     uint32_t deviceCount = 0;
     vkEnumeratePhysicalDevices(detail::getVkHandle(m_instance), &deviceCount, nullptr);
@@ -114,13 +453,35 @@ void DeviceContext::initialize(const std::vector<Surface*>&        surfaces,
     }
     assert(m_physicalDevice != VK_NULL_HANDLE);
     vkGetPhysicalDeviceMemoryProperties(m_physicalDevice, &m_memoryProperties);
+    // scoring overwrites the properties, so query them again for the selected device
+    vkGetPhysicalDeviceProperties(m_physicalDevice, &m_deviceProperties);
 
     // create a logical device
     {
-        m_requiredOperations                                        = requiredOperations;
-        const auto&                                features         = getDevicesFeatures(requiredFeatures);
+        m_requiredOperations                                         = requiredOperations;
+        const std::vector<VkExtensionProperties> availableExtensions = getDeviceExtensions(m_physicalDevice);
+
+        // the optional features are only enabled if the selected device supports them
+        m_enabledFeatures = requiredFeatures;
+        {
+            DeviceFeatures supported;
+            querySupportedFeatures(m_instance, m_physicalDevice, availableExtensions, optionalFeatures, supported);
+            for (auto feature : optionalFeatures)
+            {
+                if (!featureEnabled(feature) && hasFeature(m_instance, availableExtensions, supported, feature))
+                    m_enabledFeatures.push_back(feature);
+            }
+        }
+
+        DeviceFeatures supported;
+        querySupportedFeatures(m_instance, m_physicalDevice, availableExtensions, m_enabledFeatures, supported);
+        DeviceFeatures features;
+        getDevicesFeatures(m_enabledFeatures, supported, features);
+        m_extendedDynamicStates = getExtendedDynamicStates(features);
+        if (featureEnabled(DeviceFeature::ePushDescriptor))
+            m_functions.maxPushDescriptors = queryMaxPushDescriptors(m_instance, m_physicalDevice);
         const std::vector<VkDeviceQueueCreateInfo> queueCreateInfos = attachSurfaces(surfaces.data(), surfaces.size());
-        createDevice(queueCreateInfos, features.first, features.second);
+        createDevice(queueCreateInfos, features.features, features.extensions, features.next);
         assert(m_handle != VK_NULL_HANDLE);
     }
 
@@ -147,9 +508,7 @@ CommandPool& DeviceContext::addCommandPool(DeviceOperation operation, const Comm
 
 uint32_t DeviceContext::deviceScore(VkPhysicalDevice device, const std::vector<DeviceFeature>& requiredFeatures)
 {
-    VkPhysicalDeviceFeatures deviceFeatures;
     vkGetPhysicalDeviceProperties(device, &m_deviceProperties);
-    vkGetPhysicalDeviceFeatures(device, &deviceFeatures);
 
     uint32_t             score        = 0;
     VkPhysicalDeviceType validTypes[] = {VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU, VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU};
@@ -163,52 +522,14 @@ uint32_t DeviceContext::deviceScore(VkPhysicalDevice device, const std::vector<D
     score = scoreTypes[util::index_of(validTypes, found)];
     score += m_deviceProperties.limits.maxImageDimension2D;
 
-    std::vector<VkExtensionProperties> availableExtensions;
-    {
-        uint32_t extensionCount;
-        vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
-        availableExtensions.resize(extensionCount);
-        vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
-    }
+    const std::vector<VkExtensionProperties> availableExtensions = getDeviceExtensions(device);
+    DeviceFeatures                           supported;
+    querySupportedFeatures(m_instance, device, availableExtensions, requiredFeatures, supported);
 
-    bool hasAllFeatures = true;
     for (auto feature : requiredFeatures)
     {
-        switch (feature.get())
-        {
-            case DeviceFeature::eGeometryShader:
-                hasAllFeatures &= deviceFeatures.geometryShader == VK_TRUE;
-                break;
-            case DeviceFeature::eTesselationShader:
-                hasAllFeatures &= deviceFeatures.tessellationShader == VK_TRUE;
-                break;
-            case DeviceFeature::eFloat64:
-                hasAllFeatures &= deviceFeatures.shaderFloat64 == VK_TRUE;
-                break;
-            case DeviceFeature::eAnisotropy:
-                hasAllFeatures &= deviceFeatures.samplerAnisotropy == VK_TRUE;
-                break;
-            case DeviceFeature::eWireframe:
-                hasAllFeatures &= deviceFeatures.fillModeNonSolid == VK_TRUE;
-                break;
-            case DeviceFeature::eSampleRateShading:
-                hasAllFeatures &= deviceFeatures.sampleRateShading == VK_TRUE;
-                break;
-            default:
-                auto found = kDeviceStringMap.find(feature);
-                assert(found != kDeviceStringMap.end());
-                const auto& extensionName = found->second;
-                hasAllFeatures &= std::find_if(availableExtensions.begin(), availableExtensions.end(),
-                                               [extensionName](const VkExtensionProperties& e) {
-                                                   return std::string(e.extensionName) == extensionName;
-                                               }) != availableExtensions.end();
-                break;
-        }
-        if (!hasAllFeatures)
-        {
-            score = 0;
-            break;
-        }
+        if (!hasFeature(m_instance, availableExtensions, supported, feature))
+            return 0;
     }
 
     return score;
@@ -291,12 +612,14 @@ inline std::vector<VkDeviceQueueCreateInfo> DeviceContext::attachSurfaces(const
 
 void DeviceContext::createDevice(const std::vector<VkDeviceQueueCreateInfo>& queueCreateInfos,
                                  const VkPhysicalDeviceFeatures&             deviceFeatures,
-                                 const std::vector<const char*>&             deviceExtensions)
+                                 const std::vector<const char*>&             deviceExtensions,
+                                 const void*                                 featuresChain)
 {
     // create logical device
     {
         VkDeviceCreateInfo createInfo   = {};
         createInfo.sType                = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+        createInfo.pNext                = featuresChain;
         createInfo.pQueueCreateInfos    = queueCreateInfos.data();
         createInfo.queueCreateInfoCount = queueCreateInfos.size();
         // device specific extensions
@@ -328,6 +651,12 @@ void DeviceContext::createDevice(const std::vector<VkDeviceQueueCreateInfo>& que
             vkGetDeviceQueue(m_handle, index, 0, &m_queues[i]);
         }
     }
+
+    loadDeviceFunctions(m_handle, m_functions);
+    m_descriptorLayoutCache = new DescriptorLayoutCache(m_handle);
+    m_pipelineCache         = new PipelineCache(m_handle, m_deviceProperties);
+    m_pipelineLayoutCache   = new PipelineLayoutCache(m_handle);
+    m_shaderModuleCache     = new ShaderModuleCache(*this);
 }
 
 }  // namespace ri
@@ -0,0 +1,18 @@
+
+#include <ri/Fence.h>
+
+#include <ri/DeviceContext.h>
+
+namespace ri
+{
+Fence::Fence(const DeviceContext& device, bool signaled /*= false*/)
+    : m_device(detail::getVkHandle(device))
+{
+    VkFenceCreateInfo fenceInfo = {};
+    fenceInfo.sType             = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    fenceInfo.flags             = signaled ? VK_FENCE_CREATE_SIGNALED_BIT : 0;
+
+    RI_CHECK_RESULT_MSG("couldn't create fence") = vkCreateFence(m_device, &fenceInfo, nullptr, &m_handle);
+}
+
+}  // namespace ri
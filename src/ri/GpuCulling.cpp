@@ -0,0 +1,153 @@
+
+#include <ri/GpuCulling.h>
+
+#include <cmath>
+#include <cstring>
+#include <ri/CommandBuffer.h>
+#include <ri/DeviceContext.h>
+#include <ri/ShaderModule.h>
+#include <ri/Texture.h>
+
+namespace ri
+{
+namespace
+{
+    enum Bindings
+    {
+        eViewBinding = 0,
+        eInstancesBinding,
+        eTransformsBinding,
+        eMeshesBinding,
+        eCommandsBinding,
+        eDrawCountBinding,
+        eHiZBinding
+    };
+
+    DescriptorLayoutParam getLayoutParam(bool hiZ)
+    {
+        DescriptorLayoutParam param({
+            {eViewBinding, ShaderStage::eCompute, DescriptorType::eUniformBuffer},
+            {eInstancesBinding, ShaderStage::eCompute, DescriptorType::eStorageBuffer},
+            {eTransformsBinding, ShaderStage::eCompute, DescriptorType::eStorageBuffer},
+            {eMeshesBinding, ShaderStage::eCompute, DescriptorType::eStorageBuffer},
+            {eCommandsBinding, ShaderStage::eCompute, DescriptorType::eStorageBuffer},
+            {eDrawCountBinding, ShaderStage::eCompute, DescriptorType::eStorageBuffer},
+        });
+        if (hiZ)
+            param.bindings.emplace_back(eHiZBinding, ShaderStage::eCompute, DescriptorType::eCombinedSampler);
+        return param;
+    }
+}  // namespace
+
+GpuCulling::GpuCulling(const DeviceContext& device, const ShaderModule& shader, uint32_t maxInstances,
+                       bool hiZ /*= false*/)
+    : m_maxInstances(maxInstances)
+    , m_hiZ(hiZ)
+    , m_view(device, BufferUsageFlags::eUniformDst, sizeof(View))
+    , m_commands(device, BufferUsageFlags::eIndirectStorageDst, maxInstances * sizeof(VkDrawIndexedIndirectCommand))
+    , m_drawCount(device, BufferUsageFlags::eIndirectStorageDst, sizeof(uint32_t))
+{
+    assert(maxInstances);
+    assert(shader.stage() == ShaderStage::eCompute);
+
+    const std::vector<DescriptorPool::TypeSize> availableTypes = {
+        {DescriptorType::eUniformBuffer, 1},
+        {DescriptorType::eStorageBuffer, 5},
+        {DescriptorType::eCombinedSampler, 1}};
+    m_descriptorPool.reset(new DescriptorPool(device, 1, availableTypes));
+
+    const auto layout = m_descriptorPool->createLayout(getLayoutParam(hiZ));
+    m_descriptor      = m_descriptorPool->create(layout.index);
+    m_pipeline.reset(new ComputePipeline(device, layout.layout, shader));
+    m_pipeline->setTagName("GpuCullingPipeline");
+
+    m_view.setTagName("GpuCullingView");
+    m_commands.setTagName("GpuCullingCommands");
+    m_drawCount.setTagName("GpuCullingDrawCount");
+}
+
+GpuCulling::~GpuCulling() {}
+
+void GpuCulling::setInputs(const Buffer& instances, const Buffer& transforms, const Buffer& meshes,
+                           const Texture* hiZ /*= nullptr*/)
+{
+    assert(instances.bytes() >= m_maxInstances * sizeof(Instance));
+    assert(transforms.bytes() >= m_maxInstances * sizeof(float) * 16);
+    assert(m_hiZ == (hiZ != nullptr));
+
+    DescriptorSetParams params = {
+        {eViewBinding, &m_view, DescriptorType::eUniformBuffer},
+        {eInstancesBinding, &instances, DescriptorType::eStorageBuffer},
+        {eTransformsBinding, &transforms, DescriptorType::eStorageBuffer},
+        {eMeshesBinding, &meshes, DescriptorType::eStorageBuffer},
+        {eCommandsBinding, &m_commands, DescriptorType::eStorageBuffer},
+        {eDrawCountBinding, &m_drawCount, DescriptorType::eStorageBuffer}};
+    if (hiZ)
+        params.add(eHiZBinding, hiZ, DescriptorSetParams::eCombinedSampler);
+    m_descriptor.update<eHiZBinding + 1>(params);
+}
+
+void GpuCulling::cull(CommandBuffer& buffer, const float* viewProjection, uint32_t instanceCount)
+{
+    assert(viewProjection);
+    assert(instanceCount <= m_maxInstances);
+
+    View view;
+    std::memcpy(view.viewProjection, viewProjection, sizeof(view.viewProjection));
+    extractFrustumPlanes(viewProjection, view.frustumPlanes);
+    view.instanceCount = instanceCount;
+
+    const VkCommandBuffer handle = detail::getVkHandle(buffer);
+    // wait for the previous culling pass and its draws before overwriting their inputs
+    vkCmdPipelineBarrier(handle, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 0, nullptr);
+
+    // the parameters are updated in order with the other commands
+    vkCmdUpdateBuffer(handle, detail::getVkHandle(m_view), 0, sizeof(View), &view);
+    vkCmdFillBuffer(handle, detail::getVkHandle(m_drawCount), 0, sizeof(uint32_t), 0);
+
+    VkMemoryBarrier barrier = {VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+    barrier.srcAccessMask   = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask   = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_UNIFORM_READ_BIT;
+    vkCmdPipelineBarrier(handle, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier,
+                         0, nullptr, 0, nullptr);
+
+    m_pipeline->bind(buffer, m_descriptor);
+    m_pipeline->dispatch(buffer, (instanceCount + kGroupSize - 1) / kGroupSize, 1, 1);
+
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+    vkCmdPipelineBarrier(handle, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 0, 1,
+                         &barrier, 0, nullptr, 0, nullptr);
+}
+
+void GpuCulling::draw(CommandBuffer& buffer) const
+{
+    buffer.drawIndexedIndirectCount(m_commands, m_drawCount, m_maxInstances);
+}
+
+void GpuCulling::extractFrustumPlanes(const float* viewProjection, float (&planes)[6][4])
+{
+    // rows of the column major matrix
+    auto row = [viewProjection](int index, int column) { return viewProjection[column * 4 + index]; };
+
+    for (int i = 0; i < 4; ++i)
+    {
+        planes[0][i] = row(3, i) + row(0, i);  // left
+        planes[1][i] = row(3, i) - row(0, i);  // right
+        planes[2][i] = row(3, i) + row(1, i);  // bottom
+        planes[3][i] = row(3, i) - row(1, i);  // top
+        planes[4][i] = row(2, i);              // near
+        planes[5][i] = row(3, i) - row(2, i);  // far
+    }
+
+    for (auto& plane : planes)
+    {
+        const float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+        assert(length > 0.f);
+        for (float& value : plane)
+            value /= length;
+    }
+}
+
+}  // namespace ri
@@ -0,0 +1,164 @@
+
+#include <ri/GpuProfiler.h>
+
+#include <algorithm>
+#include <ostream>
+#include <ri/CommandBuffer.h>
+#include <ri/DeviceContext.h>
+
+namespace ri
+{
+namespace
+{
+    const uint32_t kInvalidZone = 0xFFFFFFFF;
+
+    uint64_t getTimestampMask(const DeviceContext& device)
+    {
+        uint32_t queueFamilyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(detail::getDevicePhysicalHandle(device), &queueFamilyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(detail::getDevicePhysicalHandle(device), &queueFamilyCount,
+                                                 queueFamilies.data());
+
+        const uint32_t queueIndex = detail::getDeviceQueueIndex(device, DeviceOperation::eGraphics);
+        assert(queueIndex < queueFamilyCount);
+        const uint32_t validBits = queueFamilies[queueIndex].timestampValidBits;
+        assert(validBits);
+        return validBits >= 64 ? ~0ull : ((1ull << validBits) - 1);
+    }
+}  // namespace
+
+GpuProfiler* GpuProfiler::s_current = nullptr;
+
+GpuProfiler::GpuProfiler(const DeviceContext& device, uint32_t maxZones /*= 64*/, uint32_t frameLatency /*= 3*/)
+    : m_queryPool(device, QueryType::eTimestamp, maxZones * 2 * frameLatency)
+    , m_maxZones(maxZones)
+    , m_timestampPeriod(device.deviceProperties().limits.timestampPeriod)
+    , m_timestampMask(getTimestampMask(device))
+    , m_frames(frameLatency)
+    , m_timestamps(maxZones * 2)
+{
+    assert(frameLatency);
+    for (auto& frame : m_frames)
+    {
+        frame.zones.reserve(maxZones);
+        frame.depths.reserve(maxZones);
+    }
+    m_queryPool.setTagName("GpuProfilerQueries");
+}
+
+GpuProfiler::~GpuProfiler()
+{
+    if (s_current == this)
+        s_current = nullptr;
+}
+
+void GpuProfiler::beginFrame(CommandBuffer& buffer)
+{
+    assert(m_depth == 0);
+    s_current = this;
+
+    m_frameIndex         = (m_frameIndex + 1) % m_frames.size();
+    const uint32_t first = m_frameIndex * m_maxZones * 2;
+    Frame&         frame = m_frames[m_frameIndex];
+    if (!frame.zones.empty())
+        collect(frame, first);
+
+    frame.zones.clear();
+    frame.depths.clear();
+    m_queryPool.reset(buffer, first, m_maxZones * 2);
+}
+
+const GpuProfiler::ZoneStatistics* GpuProfiler::statistics(const std::string& zoneName) const
+{
+    auto found = m_zoneIndices.find(zoneName);
+    if (found == m_zoneIndices.end())
+        return nullptr;
+    return &m_statistics[found->second];
+}
+
+void GpuProfiler::resetStatistics()
+{
+    for (auto& stats : m_statistics)
+    {
+        stats.samples = 0;
+        stats.last = stats.average = stats.min = stats.max = 0.0;
+    }
+    m_droppedFrames = 0;
+}
+
+void GpuProfiler::exportStatistics(std::ostream& stream) const
+{
+    stream << "zone,depth,samples,last_ms,average_ms,min_ms,max_ms\n";
+    for (const auto& stats : m_statistics)
+    {
+        stream << stats.name << "," << stats.depth << "," << stats.samples << "," << stats.last << ","
+               << stats.average << "," << stats.min << "," << stats.max << "\n";
+    }
+}
+
+uint32_t GpuProfiler::beginZone(CommandBuffer& buffer, const char* name)
+{
+    assert(name);
+    Frame& frame = m_frames[m_frameIndex];
+    if (frame.zones.size() >= m_maxZones)
+    {
+        assert(false);
+        return kInvalidZone;
+    }
+
+    auto found = m_zoneIndices.find(name);
+    if (found == m_zoneIndices.end())
+    {
+        found = m_zoneIndices.emplace(name, (uint32_t)m_statistics.size()).first;
+        m_statistics.emplace_back();
+        m_statistics.back().name = name;
+    }
+
+    const uint32_t zone = frame.zones.size();
+    frame.zones.push_back(found->second);
+    frame.depths.push_back(m_depth++);
+
+    const uint32_t first = m_frameIndex * m_maxZones * 2;
+    m_queryPool.writeTimestamp(buffer, first + zone * 2, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+    return zone;
+}
+
+void GpuProfiler::endZone(CommandBuffer& buffer, uint32_t zone)
+{
+    if (zone == kInvalidZone)
+        return;
+
+    assert(m_depth);
+    --m_depth;
+    const uint32_t first = m_frameIndex * m_maxZones * 2;
+    m_queryPool.writeTimestamp(buffer, first + zone * 2 + 1, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+}
+
+void GpuProfiler::collect(Frame& frame, uint32_t firstQuery)
+{
+    const uint32_t queryCount = frame.zones.size() * 2;
+    // don't wait for the results, the frame is dropped if the device didn't finish it yet
+    if (!m_queryPool.results(firstQuery, queryCount, m_timestamps.data()))
+    {
+        ++m_droppedFrames;
+        return;
+    }
+
+    for (size_t i = 0; i < frame.zones.size(); ++i)
+    {
+        const uint64_t ticks = (m_timestamps[i * 2 + 1] - m_timestamps[i * 2]) & m_timestampMask;
+        // timestamp period is in nanoseconds per tick
+        const double time = ticks * m_timestampPeriod * 1e-6;
+
+        ZoneStatistics& stats = m_statistics[frame.zones[i]];
+        stats.depth           = frame.depths[i];
+        stats.last            = time;
+        stats.min             = stats.samples ? std::min(stats.min, time) : time;
+        stats.max             = stats.samples ? std::max(stats.max, time) : time;
+        ++stats.samples;
+        stats.average += (time - stats.average) / stats.samples;
+    }
+}
+
+}  // namespace ri
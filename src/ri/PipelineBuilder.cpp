@@ -0,0 +1,59 @@
+
+#include <ri/PipelineBuilder.h>
+
+#include <ri/DeviceContext.h>
+
+namespace ri
+{
+PipelineBuilder::PipelineBuilder(const DeviceContext& device,
+                                 size_t               threadCount /*= std::thread::hardware_concurrency()*/)
+    : m_device(device)
+    , m_threads(threadCount)
+{
+}
+
+PipelineBuilder::~PipelineBuilder()
+{
+    // the thread pool drains the queue before joining
+}
+
+PipelineBuilder::Future<RenderPipeline> PipelineBuilder::create(ri::RenderPass&                      pass,
+                                                                const ri::ShaderPipeline&            shaderPipeline,
+                                                                const RenderPipeline::CreateParams&  params,
+                                                                const RenderPipeline::ViewportParam& viewportParam)
+{
+    const DeviceContext& device = m_device;
+    return m_threads.submit([&device, &pass, &shaderPipeline, params, viewportParam]() {
+        return std::unique_ptr<RenderPipeline>(new RenderPipeline(device, pass, shaderPipeline, params,
+                                                                  viewportParam.viewportSize, viewportParam.viewportX,
+                                                                  viewportParam.viewportY));
+    });
+}
+
+PipelineBuilder::Future<RenderPipeline> PipelineBuilder::create(ri::RenderPass*                      pass,
+                                                                const ri::ShaderPipeline&            shaderPipeline,
+                                                                const RenderPipeline::CreateParams&  params,
+                                                                const RenderPipeline::ViewportParam& viewportParam)
+{
+    assert(pass);
+    const DeviceContext& device = m_device;
+    return m_threads.submit([&device, pass, &shaderPipeline, params, viewportParam]() {
+        return std::unique_ptr<RenderPipeline>(new RenderPipeline(device, pass, shaderPipeline, params,
+                                                                  viewportParam.viewportSize, viewportParam.viewportX,
+                                                                  viewportParam.viewportY));
+    });
+}
+
+PipelineBuilder::Future<ComputePipeline> PipelineBuilder::create(
+    DescriptorSetLayout descriptorLayout, const ri::ShaderModule& shaderModule,
+    const std::vector<ComputePipeline::PushParams>& pushConstants /*= {}*/,
+    const std::string&                              procedureName /*= "main"*/)
+{
+    const DeviceContext& device = m_device;
+    return m_threads.submit([&device, descriptorLayout, &shaderModule, pushConstants, procedureName]() {
+        return std::unique_ptr<ComputePipeline>(
+            new ComputePipeline(device, descriptorLayout, shaderModule, pushConstants, procedureName));
+    });
+}
+
+}  // namespace ri
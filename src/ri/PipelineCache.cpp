@@ -0,0 +1,111 @@
+
+#include <ri/PipelineCache.h>
+
+#include <cstring>
+#include <fstream>
+
+namespace ri
+{
+namespace
+{
+    // VkPipelineCacheHeaderVersionOne layout, the fields are tightly packed in the cache data
+    struct CacheHeader
+    {
+        uint32_t headerSize;
+        uint32_t headerVersion;
+        uint32_t vendorID;
+        uint32_t deviceID;
+        uint8_t  pipelineCacheUUID[VK_UUID_SIZE];
+    };
+    static_assert(sizeof(CacheHeader) == 16 + VK_UUID_SIZE, "INVALID_FORMAT");
+}  // namespace
+
+PipelineCache::PipelineCache(VkDevice device, const VkPhysicalDeviceProperties& properties)
+    : m_device(device)
+    , m_properties(properties)
+{
+    assert(device);
+
+    VkPipelineCacheCreateInfo cacheInfo = {};
+    cacheInfo.sType                     = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+
+    RI_CHECK_RESULT_MSG("couldn't create pipeline cache") =
+        vkCreatePipelineCache(m_device, &cacheInfo, nullptr, &m_handle);
+}
+
+PipelineCache::~PipelineCache()
+{
+    vkDestroyPipelineCache(m_device, m_handle, nullptr);
+}
+
+bool PipelineCache::load(const std::string& filepath)
+{
+    std::ifstream file(filepath, std::ios::ate | std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    const size_t      fileSize = (size_t)file.tellg();
+    std::vector<char> buffer(fileSize);
+    file.seekg(0);
+    file.read(buffer.data(), fileSize);
+    if (!file || !isCompatible(buffer.data(), buffer.size(), m_properties))
+        return false;
+
+    // merge instead of recreating, as the handle may already be referenced; the destination of the merge must be
+    // externally synchronized, hence load() can't run concurrently with the pipeline creations
+    VkPipelineCacheCreateInfo cacheInfo = {};
+    cacheInfo.sType                     = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cacheInfo.initialDataSize           = buffer.size();
+    cacheInfo.pInitialData              = buffer.data();
+
+    VkPipelineCache loadedCache;
+    if (vkCreatePipelineCache(m_device, &cacheInfo, nullptr, &loadedCache) != VK_SUCCESS)
+        return false;
+    RI_CHECK_RESULT_MSG("couldn't merge pipeline cache") = vkMergePipelineCaches(m_device, m_handle, 1, &loadedCache);
+    vkDestroyPipelineCache(m_device, loadedCache, nullptr);
+    return true;
+}
+
+bool PipelineCache::save(const std::string& filepath) const
+{
+    const std::vector<char> buffer = data();
+    if (buffer.empty())
+        return false;
+
+    std::ofstream file(filepath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+        return false;
+    file.write(buffer.data(), buffer.size());
+    return (bool)file;
+}
+
+std::vector<char> PipelineCache::data() const
+{
+    size_t size = 0;
+    RI_CHECK_RESULT_MSG("couldn't get pipeline cache size") =
+        vkGetPipelineCacheData(m_device, m_handle, &size, nullptr);
+
+    std::vector<char> buffer(size);
+    if (size)
+    {
+        RI_CHECK_RESULT_MSG("couldn't get pipeline cache data") =
+            vkGetPipelineCacheData(m_device, m_handle, &size, buffer.data());
+        buffer.resize(size);
+    }
+    return buffer;
+}
+
+bool PipelineCache::isCompatible(const void* data, size_t size, const VkPhysicalDeviceProperties& properties)
+{
+    if (!data || size < sizeof(CacheHeader))
+        return false;
+
+    CacheHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    return header.headerSize >= sizeof(CacheHeader) && header.headerSize <= size &&
+           header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+           header.vendorID == properties.vendorID && header.deviceID == properties.deviceID &&
+           std::memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+}  // namespace ri
@@ -0,0 +1,104 @@
+
+#include <ri/PipelineLayoutCache.h>
+
+#include <algorithm>
+
+namespace ri
+{
+namespace
+{
+    inline void hashCombine(size_t& seed, size_t value)
+    {
+        seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    }
+}  // namespace
+
+PipelineLayoutCache::PipelineLayoutCache(VkDevice device)
+    : m_device(device)
+{
+    assert(device);
+}
+
+PipelineLayoutCache::~PipelineLayoutCache()
+{
+    for (const auto& bucket : m_layouts)
+    {
+        for (const auto& entry : bucket.second)
+            vkDestroyPipelineLayout(m_device, entry.layout, nullptr);
+    }
+}
+
+VkPipelineLayout PipelineLayoutCache::get(const DescriptorSetLayout* setLayouts, size_t setLayoutCount,
+                                          const VkPushConstantRange* pushRanges, size_t pushRangeCount)
+{
+    assert(setLayouts || !setLayoutCount);
+    assert(pushRanges || !pushRangeCount);
+
+    // the set layouts order is the set index
+    std::vector<DescriptorSetLayout> layouts(setLayouts, setLayouts + setLayoutCount);
+    std::vector<VkPushConstantRange> ranges(pushRanges, pushRanges + pushRangeCount);
+    std::sort(ranges.begin(), ranges.end(), [](const VkPushConstantRange& lhs, const VkPushConstantRange& rhs) {
+        if (lhs.offset != rhs.offset)
+            return lhs.offset < rhs.offset;
+        if (lhs.size != rhs.size)
+            return lhs.size < rhs.size;
+        return lhs.stageFlags < rhs.stageFlags;
+    });
+    const size_t seed = hashLayout(layouts, ranges);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto& bucket = m_layouts[seed];
+    for (const auto& entry : bucket)
+    {
+        if (entry.setLayouts == layouts && equal(entry.pushRanges, ranges))
+            return entry.layout;
+    }
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+    pipelineLayoutInfo.sType                      = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount             = layouts.size();
+    pipelineLayoutInfo.pSetLayouts                = layouts.data();
+    pipelineLayoutInfo.pushConstantRangeCount     = ranges.size();
+    pipelineLayoutInfo.pPushConstantRanges        = ranges.data();
+
+    VkPipelineLayout layout;
+    RI_CHECK_RESULT_MSG("couldn't create pipeline layout") =
+        vkCreatePipelineLayout(m_device, &pipelineLayoutInfo, nullptr, &layout);
+
+    bucket.push_back(Entry({std::move(layouts), std::move(ranges), layout}));
+    ++m_layoutCount;
+    return layout;
+}
+
+size_t PipelineLayoutCache::hashLayout(const std::vector<DescriptorSetLayout>& setLayouts,
+                                       const std::vector<VkPushConstantRange>& pushRanges)
+{
+    size_t seed = setLayouts.size();
+    for (const auto setLayout : setLayouts)
+        hashCombine(seed, std::hash<DescriptorSetLayout>()(setLayout));
+    hashCombine(seed, pushRanges.size());
+    for (const auto& range : pushRanges)
+    {
+        hashCombine(seed, range.stageFlags);
+        hashCombine(seed, range.offset);
+        hashCombine(seed, range.size);
+    }
+    return seed;
+}
+
+bool PipelineLayoutCache::equal(const std::vector<VkPushConstantRange>& lhs,
+                                const std::vector<VkPushConstantRange>& rhs)
+{
+    if (lhs.size() != rhs.size())
+        return false;
+
+    for (size_t i = 0; i < lhs.size(); ++i)
+    {
+        if (lhs[i].stageFlags != rhs[i].stageFlags || lhs[i].offset != rhs[i].offset || lhs[i].size != rhs[i].size)
+            return false;
+    }
+    return true;
+}
+
+}  // namespace ri
@@ -0,0 +1,129 @@
+
+#include <ri/QueryPool.h>
+
+#include <ri/CommandBuffer.h>
+#include <ri/DeviceContext.h>
+
+namespace ri
+{
+namespace
+{
+    // ordered by the statistic bits, as results are written in that order
+    uint64_t PipelineStatistics::*const kStatisticMembers[] = {
+        &PipelineStatistics::inputVertices,       &PipelineStatistics::inputPrimitives,
+        &PipelineStatistics::vertexInvocations,   &PipelineStatistics::geometryInvocations,
+        &PipelineStatistics::geometryPrimitives,  &PipelineStatistics::clippingInvocations,
+        &PipelineStatistics::clippingPrimitives,  &PipelineStatistics::fragmentInvocations,
+        &PipelineStatistics::tessControlPatches,  &PipelineStatistics::tessEvaluationInvocations,
+        &PipelineStatistics::computeInvocations};
+
+    const uint32_t kMaxStatisticCount = sizeof(kStatisticMembers) / sizeof(kStatisticMembers[0]);
+
+    uint32_t countBits(uint32_t flags)
+    {
+        uint32_t count = 0;
+        for (; flags; flags &= flags - 1)
+            ++count;
+        return count;
+    }
+}  // namespace
+
+QueryPool::QueryPool(const DeviceContext& device, QueryType type, uint32_t queryCount,
+                     uint32_t statisticFlags /*= PipelineStatistic::eGraphics*/)
+    : m_device(detail::getVkHandle(device))
+    , m_type(type)
+    , m_queryCount(queryCount)
+    , m_statisticFlags(type == QueryType::ePipelineStatistics ? statisticFlags : 0)
+    , m_resultCount(type == QueryType::ePipelineStatistics ? countBits(statisticFlags) : 1)
+{
+    assert(queryCount);
+    assert(m_resultCount);
+    assert(m_statisticFlags < (1u << kMaxStatisticCount));
+    assert(type != QueryType::eTimestamp || device.deviceProperties().limits.timestampComputeAndGraphics);
+
+    VkQueryPoolCreateInfo poolInfo = {};
+    poolInfo.sType                 = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    poolInfo.queryType             = (VkQueryType)type;
+    poolInfo.queryCount            = queryCount;
+    poolInfo.pipelineStatistics    = m_statisticFlags;
+
+    RI_CHECK_RESULT_MSG("couldn't create query pool") = vkCreateQueryPool(m_device, &poolInfo, nullptr, &m_handle);
+}
+
+QueryPool::~QueryPool()
+{
+    vkDestroyQueryPool(m_device, m_handle, nullptr);
+}
+
+void QueryPool::reset(CommandBuffer& buffer, uint32_t firstQuery, uint32_t queryCount)
+{
+    assert((firstQuery + queryCount) <= m_queryCount);
+    vkCmdResetQueryPool(detail::getVkHandle(buffer), m_handle, firstQuery, queryCount);
+}
+
+void QueryPool::begin(CommandBuffer& buffer, uint32_t query, bool precise /*= false*/)
+{
+    assert(m_type != QueryType::eTimestamp);
+    assert(query < m_queryCount);
+    assert(!precise || m_type == QueryType::eOcclusion);
+    vkCmdBeginQuery(detail::getVkHandle(buffer), m_handle, query, precise ? VK_QUERY_CONTROL_PRECISE_BIT : 0);
+}
+
+void QueryPool::end(CommandBuffer& buffer, uint32_t query)
+{
+    assert(m_type != QueryType::eTimestamp);
+    assert(query < m_queryCount);
+    vkCmdEndQuery(detail::getVkHandle(buffer), m_handle, query);
+}
+
+void QueryPool::writeTimestamp(CommandBuffer& buffer, uint32_t query,
+                               VkPipelineStageFlagBits stage /*= VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT*/)
+{
+    assert(m_type == QueryType::eTimestamp);
+    assert(query < m_queryCount);
+    vkCmdWriteTimestamp(detail::getVkHandle(buffer), stage, m_handle, query);
+}
+
+bool QueryPool::results(uint32_t firstQuery, uint32_t queryCount, uint64_t* data) const
+{
+    assert(data);
+    assert((firstQuery + queryCount) <= m_queryCount);
+
+    const size_t   stride = m_resultCount * sizeof(uint64_t);
+    const VkResult res    = vkGetQueryPoolResults(m_device, m_handle, firstQuery, queryCount, queryCount * stride,
+                                               data, stride, VK_QUERY_RESULT_64_BIT);
+    assert(res == VK_SUCCESS || res == VK_NOT_READY);
+    return res == VK_SUCCESS;
+}
+
+bool QueryPool::results(uint32_t query, PipelineStatistics& statistics) const
+{
+    assert(m_type == QueryType::ePipelineStatistics);
+
+    uint64_t values[kMaxStatisticCount];
+    if (!results(query, 1, values))
+        return false;
+
+    uint32_t index = 0;
+    for (uint32_t i = 0; i < kMaxStatisticCount; ++i)
+    {
+        if (m_statisticFlags & (1u << i))
+            statistics.*kStatisticMembers[i] = values[index++];
+    }
+    return true;
+}
+
+bool QueryPool::available(uint32_t query) const
+{
+    assert(query < m_queryCount);
+
+    // the availability value is written after the results
+    uint64_t       values[kMaxStatisticCount + 1];
+    const size_t   stride = (m_resultCount + 1) * sizeof(uint64_t);
+    const VkResult res    = vkGetQueryPoolResults(m_device, m_handle, query, 1, stride, values, stride,
+                                               VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+    assert(res == VK_SUCCESS || res == VK_NOT_READY);
+    return values[m_resultCount] != 0;
+}
+
+}  // namespace ri
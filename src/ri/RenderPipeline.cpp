@@ -1,7 +1,13 @@
 
 #include <ri/RenderPipeline.h>
 
+#include <algorithm>
+#include <ri/CommandBuffer.h>
+#include <ri/DeviceContext.h>
+#include <ri/PipelineCache.h>
+#include <ri/PipelineLayoutCache.h>
 #include <ri/RenderPass.h>
+#include <ri/RenderPipelineLibrary.h>
 #include <ri/ShaderPipeline.h>
 #include <ri/VertexDescription.h>
 
@@ -39,12 +45,56 @@ RenderPipeline::RenderPipeline(const ri::DeviceContext&  device,          //
     m_viewport = getViewportFrom(viewportParam);
     m_scissor  = getScissorFrom(viewportParam);
 
-    m_pipelineLayout = createLayout(m_device, params, params.descriptorLayouts);
+    // the derivative index only refers to pipelines of the same batch
+    assert(params.pipelineDerivativeIndex < 0);
+    m_pipelineLayout = createLayout(device, params, params.descriptorLayouts);
     const VkGraphicsPipelineCreateInfo info =
         getPipelineCreateInfo(pass, shaderPipeline, params, data, m_pipelineLayout);
 
     RI_CHECK_RESULT_MSG("couldn't create render pipeline") =
-        vkCreateGraphicsPipelines(detail::getVkHandle(device), VK_NULL_HANDLE, 1, &info, nullptr, &m_handle);
+        vkCreateGraphicsPipelines(m_device, detail::getVkHandle(device.pipelineCache()), 1, &info, nullptr, &m_handle);
+}
+
+RenderPipeline::RenderPipeline(const ri::DeviceContext&                         device,     //
+                               ri::RenderPass&                                  pass,       //
+                               const std::vector<const RenderPipelineLibrary*>& libraries,  //
+                               bool                                             optimize /*= false*/)
+    : m_device(detail::getVkHandle(device))
+    , m_renderPass(&pass)
+{
+    int                     parts = 0;
+    std::vector<VkPipeline> libraryHandles;
+    libraryHandles.reserve(libraries.size());
+    for (const auto library : libraries)
+    {
+        assert(library);
+        assert((parts & library->parts()) == 0);
+        parts |= library->parts();
+        libraryHandles.push_back(detail::getVkHandle(*library));
+
+        // the shader parts have the complete layout
+        if (library->parts() & RenderPipelineLibrary::ePreRasterization)
+        {
+            m_pipelineLayout = library->m_pipelineLayout;
+            m_viewport       = library->m_viewport;
+            m_scissor        = library->m_scissor;
+        }
+    }
+    assert(parts == RenderPipelineLibrary::eAll);
+    assert(m_pipelineLayout);
+
+    VkPipelineLibraryCreateInfoKHR libraryInfo = {VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR};
+    libraryInfo.libraryCount                   = libraryHandles.size();
+    libraryInfo.pLibraries                     = libraryHandles.data();
+
+    VkGraphicsPipelineCreateInfo info = {VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO};
+    info.pNext                        = &libraryInfo;
+    info.flags                        = optimize ? VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT : 0;
+    info.layout                       = m_pipelineLayout;
+    info.basePipelineIndex            = -1;
+
+    RI_CHECK_RESULT_MSG("couldn't link render pipeline") =
+        vkCreateGraphicsPipelines(m_device, detail::getVkHandle(device.pipelineCache()), 1, &info, nullptr, &m_handle);
 }
 
 RenderPipeline::~RenderPipeline()
@@ -52,7 +102,7 @@ RenderPipeline::~RenderPipeline()
     if (m_hasOwnership)
         delete m_renderPass;
     vkDestroyPipeline(m_device, m_handle, nullptr);
-    vkDestroyPipelineLayout(m_device, m_pipelineLayout, nullptr);
+    // the layout is owned by the device's pipeline layout cache
 }
 
 void RenderPipeline::create(const ri::DeviceContext&                          device,                   //
@@ -69,7 +119,8 @@ void RenderPipeline::create(const ri::DeviceContext&                          de
     assert(pipelinesPass.size() == pipelinesShaders.size());
 
     std::vector<VkPipeline>         pipelineHandles(pipelinesParams.size());
-    std::vector<VkPipelineLayout>   pipelineLayoutHandles(pipelinesParams.size());
+    std::vector<VkPipelineLayout>   pipelineLayoutHandles;
+    pipelineLayoutHandles.reserve(pipelinesParams.size());
     std::vector<PipelineCreateData> pipelineCreateData;
     pipelineCreateData.reserve(pipelinesParams.size());
     std::vector<VkGraphicsPipelineCreateInfo> pipelineInfos;
@@ -81,15 +132,22 @@ void RenderPipeline::create(const ri::DeviceContext&                          de
         pipelineCreateData.emplace_back(*pipelinesPass[i], params,
                                         pipelinesViewportParams[std::min(i, pipelinesViewportParams.size() - 1)]);
         const auto& data   = pipelineCreateData.back();
-        const auto  layout = createLayout(detail::getVkHandle(device), params, descriptorLayouts);
+        const auto  layout = createLayout(device, params, descriptorLayouts);
         pipelineLayoutHandles.push_back(layout);
         pipelineInfos.push_back(
             getPipelineCreateInfo(*pipelinesPass[i], *pipelinesShaders[i], pipelinesParams[i], data, layout));
+
+        // a parent of the batch must allow derivatives
+        if (params.pipelineDerivativeIndex >= 0)
+        {
+            assert(params.pipelineDerivativeIndex < (int)i);
+            pipelineInfos[params.pipelineDerivativeIndex].flags |= VK_PIPELINE_CREATE_ALLOW_DERIVATIVES_BIT;
+        }
     }
 
     RI_CHECK_RESULT_MSG("couldn't create multiple render pipelines") =
-        vkCreateGraphicsPipelines(detail::getVkHandle(device), VK_NULL_HANDLE, pipelineInfos.size(),
-                                  pipelineInfos.data(), nullptr, pipelineHandles.data());
+        vkCreateGraphicsPipelines(detail::getVkHandle(device), detail::getVkHandle(device.pipelineCache()),
+                                  pipelineInfos.size(), pipelineInfos.data(), nullptr, pipelineHandles.data());
 
     pipelines.resize(pipelinesParams.size());
     for (size_t i = 0; i < pipelineHandles.size(); ++i)
@@ -101,7 +159,7 @@ void RenderPipeline::create(const ri::DeviceContext&                          de
     }
 }
 
-inline VkViewport RenderPipeline::getViewportFrom(const RenderPipeline::ViewportParam& viewportParam)
+VkViewport RenderPipeline::getViewportFrom(const RenderPipeline::ViewportParam& viewportParam)
 {
     VkViewport viewport;
     viewport.x        = (float)viewportParam.viewportX;
@@ -113,7 +171,7 @@ inline VkViewport RenderPipeline::getViewportFrom(const RenderPipeline::Viewport
     return viewport;
 }
 
-inline VkRect2D RenderPipeline::getScissorFrom(const RenderPipeline::ViewportParam& viewportParam)
+VkRect2D RenderPipeline::getScissorFrom(const RenderPipeline::ViewportParam& viewportParam)
 {
     VkRect2D scissor;
     scissor.offset = {viewportParam.viewportX, viewportParam.viewportY};
@@ -121,7 +179,7 @@ inline VkRect2D RenderPipeline::getScissorFrom(const RenderPipeline::ViewportPar
     return scissor;
 }
 
-inline VkPipelineVertexInputStateCreateInfo RenderPipeline::getVertexInputInfo(const CreateParams& params)
+VkPipelineVertexInputStateCreateInfo RenderPipeline::getVertexInputInfo(const CreateParams& params)
 {
     VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
     vertexInputInfo.sType                                = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
@@ -143,7 +201,7 @@ inline VkPipelineVertexInputStateCreateInfo RenderPipeline::getVertexInputInfo(c
     return vertexInputInfo;
 }
 
-inline VkPipelineInputAssemblyStateCreateInfo RenderPipeline::getInputAssemblyInfo(const CreateParams& params)
+VkPipelineInputAssemblyStateCreateInfo RenderPipeline::getInputAssemblyInfo(const CreateParams& params)
 {
     VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
     inputAssembly.sType                                  = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
@@ -153,8 +211,8 @@ inline VkPipelineInputAssemblyStateCreateInfo RenderPipeline::getInputAssemblyIn
     return inputAssembly;
 }
 
-inline VkPipelineViewportStateCreateInfo RenderPipeline::getViewportStateInfo(const VkViewport& viewport,
-                                                                              const VkRect2D&   scissor)
+VkPipelineViewportStateCreateInfo RenderPipeline::getViewportStateInfo(const VkViewport& viewport,
+                                                                       const VkRect2D&   scissor)
 {
     VkPipelineViewportStateCreateInfo viewportState = {};
     viewportState.sType                             = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
@@ -166,7 +224,7 @@ inline VkPipelineViewportStateCreateInfo RenderPipeline::getViewportStateInfo(co
     return viewportState;
 }
 
-inline VkPipelineRasterizationStateCreateInfo RenderPipeline::getRasterizerInfo(const CreateParams& params)
+VkPipelineRasterizationStateCreateInfo RenderPipeline::getRasterizerInfo(const CreateParams& params)
 {
     VkPipelineRasterizationStateCreateInfo rasterizer = {};
     rasterizer.sType                                  = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
@@ -185,7 +243,7 @@ inline VkPipelineRasterizationStateCreateInfo RenderPipeline::getRasterizerInfo(
     return rasterizer;
 }
 
-inline VkPipelineMultisampleStateCreateInfo RenderPipeline::getMultisamplingInfo(const CreateParams& params)
+VkPipelineMultisampleStateCreateInfo RenderPipeline::getMultisamplingInfo(const CreateParams& params)
 {
     VkPipelineMultisampleStateCreateInfo multisampling = {};
     multisampling.sType                                = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
@@ -199,7 +257,7 @@ inline VkPipelineMultisampleStateCreateInfo RenderPipeline::getMultisamplingInfo
     return multisampling;
 }
 
-inline VkPipelineColorBlendAttachmentState RenderPipeline::getColorBlendAttachmentInfo(const CreateParams& params)
+VkPipelineColorBlendAttachmentState RenderPipeline::getColorBlendAttachmentInfo(const CreateParams& params)
 {
     VkPipelineColorBlendAttachmentState colorBlendAttachment = {};
     const VkColorComponentFlags         writeAllMask =
@@ -216,7 +274,7 @@ inline VkPipelineColorBlendAttachmentState RenderPipeline::getColorBlendAttachme
     return colorBlendAttachment;
 }
 
-inline VkPipelineColorBlendStateCreateInfo RenderPipeline::getColorBlendingInfo(
+VkPipelineColorBlendStateCreateInfo RenderPipeline::getColorBlendingInfo(
     const CreateParams& params, const VkPipelineColorBlendAttachmentState& colorBlendAttachment)
 {
     VkPipelineColorBlendStateCreateInfo colorBlending = {};
@@ -233,7 +291,7 @@ inline VkPipelineColorBlendStateCreateInfo RenderPipeline::getColorBlendingInfo(
     return colorBlending;
 }
 
-inline VkPipelineDynamicStateCreateInfo RenderPipeline::getDynamicStateInfo(const CreateParams& params)
+VkPipelineDynamicStateCreateInfo RenderPipeline::getDynamicStateInfo(const CreateParams& params)
 {
     VkPipelineDynamicStateCreateInfo dynamicState = {};
     if (!params.dynamicStates.empty())
@@ -246,8 +304,8 @@ inline VkPipelineDynamicStateCreateInfo RenderPipeline::getDynamicStateInfo(cons
     return dynamicState;
 }
 
-inline VkPipelineDepthStencilStateCreateInfo RenderPipeline::getDepthStencilInfo(const ri::RenderPass& pass,
-                                                                                 const CreateParams&   params)
+VkPipelineDepthStencilStateCreateInfo RenderPipeline::getDepthStencilInfo(const ri::RenderPass& pass,
+                                                                          const CreateParams&   params)
 {
     VkPipelineDepthStencilStateCreateInfo depthStencil = {};
 
@@ -273,7 +331,7 @@ inline VkPipelineDepthStencilStateCreateInfo RenderPipeline::getDepthStencilInfo
     return depthStencil;
 }
 
-inline VkPipelineTessellationStateCreateInfo RenderPipeline::getTesselationStateInfo(const CreateParams& params)
+VkPipelineTessellationStateCreateInfo RenderPipeline::getTesselationStateInfo(const CreateParams& params)
 {
     VkPipelineTessellationStateCreateInfo tesselation = {};
     tesselation.sType                                 = VK_STRUCTURE_TYPE_PIPELINE_TESSELLATION_STATE_CREATE_INFO;
@@ -281,13 +339,12 @@ inline VkPipelineTessellationStateCreateInfo RenderPipeline::getTesselationState
     return tesselation;
 }
 
-inline VkPipelineLayout RenderPipeline::createLayout(const VkDevice device, const CreateParams& params,
-                                                     const std::vector<VkDescriptorSetLayout>& descriptorLayouts)
+VkPipelineLayout RenderPipeline::createLayout(const ri::DeviceContext& device, const CreateParams& params,
+                                              const std::vector<VkDescriptorSetLayout>& descriptorLayouts)
 {
-    VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
-    pipelineLayoutInfo.sType                      = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutInfo.setLayoutCount             = descriptorLayouts.size();
-    pipelineLayoutInfo.pSetLayouts                = descriptorLayouts.data();
+    // every creation path builds its layout, so the dynamic states are checked here
+    assert(std::all_of(params.dynamicStates.begin(), params.dynamicStates.end(),
+                       [&device](ri::DynamicState state) { return device.supportsDynamicState(state); }));
 
     std::vector<VkPushConstantRange> ranges(params.pushConstants.size());
     for (size_t i = 0; i < ranges.size(); ++i)
@@ -298,20 +355,14 @@ inline VkPipelineLayout RenderPipeline::createLayout(const VkDevice device, cons
         range.size            = pushParam.size;
         range.stageFlags      = (VkShaderStageFlags)pushParam.stages;
     }
-    pipelineLayoutInfo.pushConstantRangeCount = ranges.size();
-    pipelineLayoutInfo.pPushConstantRanges    = ranges.data();
-
-    VkPipelineLayout pipelineLayout;
-    RI_CHECK_RESULT_MSG("couldn't create pipeline layout") =
-        vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout);
-    return pipelineLayout;
+    return device.pipelineLayoutCache().get(descriptorLayouts, ranges);
 }
 
-inline VkGraphicsPipelineCreateInfo RenderPipeline::getPipelineCreateInfo(const ri::RenderPass&     pass,
-                                                                          const ri::ShaderPipeline& shaderPipeline,
-                                                                          const CreateParams&       params,
-                                                                          const PipelineCreateData& data,
-                                                                          VkPipelineLayout          pipelineLayout)
+VkGraphicsPipelineCreateInfo RenderPipeline::getPipelineCreateInfo(const ri::RenderPass&     pass,
+                                                                   const ri::ShaderPipeline& shaderPipeline,
+                                                                   const CreateParams&       params,
+                                                                   const PipelineCreateData& data,
+                                                                   VkPipelineLayout          pipelineLayout)
 {
     VkGraphicsPipelineCreateInfo pipelineInfo = {};
     pipelineInfo.sType                        = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
@@ -337,13 +388,148 @@ inline VkGraphicsPipelineCreateInfo RenderPipeline::getPipelineCreateInfo(const
     assert(params.activeSubpassIndex < pass.subpassCount());
     pipelineInfo.subpass = params.activeSubpassIndex;
 
+    if (params.allowDerivatives)
+        pipelineInfo.flags |= VK_PIPELINE_CREATE_ALLOW_DERIVATIVES_BIT;
+    // only one of the base handle or index may be used
+    pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+    pipelineInfo.basePipelineIndex  = -1;
     if (params.pipelineDerivative)
+    {
+        pipelineInfo.flags |= VK_PIPELINE_CREATE_DERIVATIVE_BIT;
         pipelineInfo.basePipelineHandle = params.pipelineDerivative->m_handle;
-    else
-        pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
-    pipelineInfo.basePipelineIndex = params.pipelineDerivativeIndex;
+    }
+    else if (params.pipelineDerivativeIndex >= 0)
+    {
+        pipelineInfo.flags |= VK_PIPELINE_CREATE_DERIVATIVE_BIT;
+        pipelineInfo.basePipelineIndex = params.pipelineDerivativeIndex;
+    }
 
     return pipelineInfo;
 }
 
+void RenderPipeline::DynamicState::setCullMode(CommandBuffer& buffer, CullMode cullMode)
+{
+    const auto& functions = detail::getDeviceFunctions(buffer);
+    assert(functions.cmdSetCullMode);
+    functions.cmdSetCullMode(detail::getVkHandle(buffer), (VkCullModeFlags)cullMode);
+}
+
+void RenderPipeline::DynamicState::setFrontFace(CommandBuffer& buffer, bool frontFaceCW)
+{
+    const auto& functions = detail::getDeviceFunctions(buffer);
+    assert(functions.cmdSetFrontFace);
+    functions.cmdSetFrontFace(detail::getVkHandle(buffer),
+                              frontFaceCW ? VK_FRONT_FACE_CLOCKWISE : VK_FRONT_FACE_COUNTER_CLOCKWISE);
+}
+
+void RenderPipeline::DynamicState::setPrimitiveTopology(CommandBuffer& buffer, PrimitiveTopology primitiveTopology)
+{
+    const auto& functions = detail::getDeviceFunctions(buffer);
+    assert(functions.cmdSetPrimitiveTopology);
+    functions.cmdSetPrimitiveTopology(detail::getVkHandle(buffer), (VkPrimitiveTopology)primitiveTopology);
+}
+
+void RenderPipeline::DynamicState::setDepthTestEnable(CommandBuffer& buffer, bool enable)
+{
+    const auto& functions = detail::getDeviceFunctions(buffer);
+    assert(functions.cmdSetDepthTestEnable);
+    functions.cmdSetDepthTestEnable(detail::getVkHandle(buffer), enable ? VK_TRUE : VK_FALSE);
+}
+
+void RenderPipeline::DynamicState::setDepthWriteEnable(CommandBuffer& buffer, bool enable)
+{
+    const auto& functions = detail::getDeviceFunctions(buffer);
+    assert(functions.cmdSetDepthWriteEnable);
+    functions.cmdSetDepthWriteEnable(detail::getVkHandle(buffer), enable ? VK_TRUE : VK_FALSE);
+}
+
+void RenderPipeline::DynamicState::setDepthCompareOp(CommandBuffer& buffer, CompareOperation compareOp)
+{
+    const auto& functions = detail::getDeviceFunctions(buffer);
+    assert(functions.cmdSetDepthCompareOp);
+    functions.cmdSetDepthCompareOp(detail::getVkHandle(buffer), (VkCompareOp)compareOp);
+}
+
+void RenderPipeline::DynamicState::setDepthBoundsTestEnable(CommandBuffer& buffer, bool enable)
+{
+    const auto& functions = detail::getDeviceFunctions(buffer);
+    assert(functions.cmdSetDepthBoundsTestEnable);
+    functions.cmdSetDepthBoundsTestEnable(detail::getVkHandle(buffer), enable ? VK_TRUE : VK_FALSE);
+}
+
+void RenderPipeline::DynamicState::setStencilTestEnable(CommandBuffer& buffer, bool enable)
+{
+    const auto& functions = detail::getDeviceFunctions(buffer);
+    assert(functions.cmdSetStencilTestEnable);
+    functions.cmdSetStencilTestEnable(detail::getVkHandle(buffer), enable ? VK_TRUE : VK_FALSE);
+}
+
+void RenderPipeline::DynamicState::setStencilOp(CommandBuffer& buffer, VkStencilFaceFlags faceMask, VkStencilOp failOp,
+                                                VkStencilOp passOp, VkStencilOp depthFailOp,
+                                                CompareOperation compareOp)
+{
+    const auto& functions = detail::getDeviceFunctions(buffer);
+    assert(functions.cmdSetStencilOp);
+    functions.cmdSetStencilOp(detail::getVkHandle(buffer), faceMask, failOp, passOp, depthFailOp,
+                              (VkCompareOp)compareOp);
+}
+
+void RenderPipeline::DynamicState::setRasterizerDiscardEnable(CommandBuffer& buffer, bool enable)
+{
+    const auto& functions = detail::getDeviceFunctions(buffer);
+    assert(functions.cmdSetRasterizerDiscardEnable);
+    functions.cmdSetRasterizerDiscardEnable(detail::getVkHandle(buffer), enable ? VK_TRUE : VK_FALSE);
+}
+
+void RenderPipeline::DynamicState::setDepthBiasEnable(CommandBuffer& buffer, bool enable)
+{
+    const auto& functions = detail::getDeviceFunctions(buffer);
+    assert(functions.cmdSetDepthBiasEnable);
+    functions.cmdSetDepthBiasEnable(detail::getVkHandle(buffer), enable ? VK_TRUE : VK_FALSE);
+}
+
+void RenderPipeline::DynamicState::setPrimitiveRestartEnable(CommandBuffer& buffer, bool enable)
+{
+    const auto& functions = detail::getDeviceFunctions(buffer);
+    assert(functions.cmdSetPrimitiveRestartEnable);
+    functions.cmdSetPrimitiveRestartEnable(detail::getVkHandle(buffer), enable ? VK_TRUE : VK_FALSE);
+}
+
+void RenderPipeline::DynamicState::setPatchControlPoints(CommandBuffer& buffer, uint32_t patchControlPoints)
+{
+    const auto& functions = detail::getDeviceFunctions(buffer);
+    assert(functions.cmdSetPatchControlPoints);
+    functions.cmdSetPatchControlPoints(detail::getVkHandle(buffer), patchControlPoints);
+}
+
+void RenderPipeline::DynamicState::setPolygonMode(CommandBuffer& buffer, PolygonMode polygonMode)
+{
+    const auto& functions = detail::getDeviceFunctions(buffer);
+    assert(functions.cmdSetPolygonMode);
+    functions.cmdSetPolygonMode(detail::getVkHandle(buffer), (VkPolygonMode)polygonMode);
+}
+
+void RenderPipeline::DynamicState::setDepthClampEnable(CommandBuffer& buffer, bool enable)
+{
+    const auto& functions = detail::getDeviceFunctions(buffer);
+    assert(functions.cmdSetDepthClampEnable);
+    functions.cmdSetDepthClampEnable(detail::getVkHandle(buffer), enable ? VK_TRUE : VK_FALSE);
+}
+
+void RenderPipeline::DynamicState::setColorBlendEnable(CommandBuffer& buffer, bool enable, uint32_t attachment)
+{
+    const auto& functions = detail::getDeviceFunctions(buffer);
+    assert(functions.cmdSetColorBlendEnable);
+    const VkBool32 blendEnable = enable ? VK_TRUE : VK_FALSE;
+    functions.cmdSetColorBlendEnable(detail::getVkHandle(buffer), attachment, 1, &blendEnable);
+}
+
+void RenderPipeline::DynamicState::setColorWriteMask(CommandBuffer& buffer, VkColorComponentFlags writeMask,
+                                                     uint32_t attachment)
+{
+    const auto& functions = detail::getDeviceFunctions(buffer);
+    assert(functions.cmdSetColorWriteMask);
+    functions.cmdSetColorWriteMask(detail::getVkHandle(buffer), attachment, 1, &writeMask);
+}
+
 }  // namespace ri
@@ -0,0 +1,495 @@
+
+#include <ri/RenderPipelineCache.h>
+
+#include <algorithm>
+#include <cstring>
+#include <ri/RenderPass.h>
+#include <ri/ShaderPipeline.h>
+#include <ri/VertexDescription.h>
+
+namespace ri
+{
+namespace
+{
+    inline void hashCombine(size_t& seed, size_t value)
+    {
+        seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    }
+
+    inline void append(std::vector<uint32_t>& key, uint32_t value)
+    {
+        key.push_back(value);
+    }
+
+    inline void append(std::vector<uint32_t>& key, int32_t value)
+    {
+        key.push_back((uint32_t)value);
+    }
+
+    inline void append(std::vector<uint32_t>& key, bool value)
+    {
+        key.push_back(value ? 1 : 0);
+    }
+
+    inline void append(std::vector<uint32_t>& key, float value)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        key.push_back(bits);
+    }
+
+    inline void appendHandle(std::vector<uint32_t>& key, uint64_t handle)
+    {
+        key.push_back((uint32_t)handle);
+        key.push_back((uint32_t)(handle >> 32));
+    }
+
+    inline bool hasDynamicState(const RenderPipeline::CreateParams& params, DynamicState state)
+    {
+        return std::find(params.dynamicStates.begin(), params.dynamicStates.end(), state) !=
+               params.dynamicStates.end();
+    }
+
+    void append(std::vector<uint32_t>& key, const StencilOpState& state, const RenderPipeline::CreateParams& params)
+    {
+        if (!hasDynamicState(params, DynamicState::eStencilOp))
+        {
+            append(key, (uint32_t)state.failOp);
+            append(key, (uint32_t)state.passOp);
+            append(key, (uint32_t)state.depthFailOp);
+            append(key, (uint32_t)state.compareOp);
+        }
+        if (!hasDynamicState(params, DynamicState::eStencilCompareMask))
+            append(key, state.compareMask);
+        if (!hasDynamicState(params, DynamicState::eStencilWriteMask))
+            append(key, state.writeMask);
+        if (!hasDynamicState(params, DynamicState::eStencilReference))
+            append(key, state.reference);
+    }
+
+    // with a dynamic topology only the topology class must match the draws
+    uint32_t topologyClass(PrimitiveTopology topology)
+    {
+        switch (topology.get())
+        {
+            case PrimitiveTopology::ePoints:
+                return 0;
+            case PrimitiveTopology::eLines:
+            case PrimitiveTopology::eLineStrip:
+            case PrimitiveTopology::eLineListAdjaceny:
+            case PrimitiveTopology::eLineStripAdjaceny:
+                return 1;
+            case PrimitiveTopology::ePatchList:
+                return 3;
+            default:
+                return 2;
+        }
+    }
+}  // namespace
+
+RenderPipelineCache::RenderPipelineCache(const DeviceContext& device, PipelineBuilder* builder /*= nullptr*/)
+    : m_device(device)
+    , m_builder(builder)
+{
+}
+
+RenderPipelineCache::~RenderPipelineCache()
+{
+    // the pending pipelines must be destroyed before the device
+    finish();
+}
+
+RenderPipeline& RenderPipelineCache::get(RenderPass& pass, const ShaderPipeline& shaderPipeline,
+                                         const RenderPipeline::CreateParams&  params,
+                                         const RenderPipeline::ViewportParam& viewportParam)
+{
+    Key          key  = makeKey(pass, shaderPipeline, params, viewportParam);
+    const size_t seed = hashKey(key);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    // a failed creation removes its entry, the state is then created again
+    while (EntryPtr entry = find(key, seed))
+    {
+        if (!entry->pipeline)
+        {
+            const auto start = Clock::now();
+            const bool ready = wait(*entry, lock);
+            addStall(start);
+            if (!ready)
+                continue;
+        }
+        ++m_statistics.hits;
+        return *entry->pipeline;
+    }
+
+    ++m_statistics.misses;
+
+    // the entry is inserted before the creation, meanwhile get() of the same state waits and request() falls back
+    EntryPtr entry = insert(std::move(key), seed);
+    lock.unlock();
+
+    const auto                      start = Clock::now();
+    std::unique_ptr<RenderPipeline> pipeline;
+    try
+    {
+        pipeline.reset(new RenderPipeline(m_device, pass, shaderPipeline, params, viewportParam.viewportSize,
+                                          viewportParam.viewportX, viewportParam.viewportY));
+    }
+    catch (...)
+    {
+        lock.lock();
+        discard(*entry);
+        throw;
+    }
+
+    lock.lock();
+    addStall(start);
+    entry->pipeline = std::move(pipeline);
+    m_ready.notify_all();
+    return *entry->pipeline;
+}
+
+RenderPipeline* RenderPipelineCache::request(RenderPass& pass, const ShaderPipeline& shaderPipeline,
+                                             const RenderPipeline::CreateParams&  params,
+                                             const RenderPipeline::ViewportParam& viewportParam)
+{
+    if (!m_builder)
+        return &get(pass, shaderPipeline, params, viewportParam);
+
+    Key          key  = makeKey(pass, shaderPipeline, params, viewportParam);
+    const size_t seed = hashKey(key);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    EntryPtr entry = find(key, seed);
+    if (entry)
+    {
+        ++m_statistics.hits;
+        if (!entry->pipeline && entry->pending.valid() && PipelineBuilder::isReady(entry->pending))
+        {
+            PipelineBuilder::Future<RenderPipeline> pending = std::move(entry->pending);
+            resolve(*entry, pending);
+        }
+        if (entry->pipeline)
+            return entry->pipeline.get();
+    }
+    else
+    {
+        ++m_statistics.misses;
+
+        entry              = insert(std::move(key), seed);
+        entry->pending     = m_builder->create(pass, shaderPipeline, params, viewportParam);
+        entry->requestTime = Clock::now();
+        ++m_pendingCount;
+    }
+
+    if (m_fallback)
+        ++m_statistics.fallbacks;
+    else
+        ++m_statistics.skipped;
+    return m_fallback;
+}
+
+void RenderPipelineCache::finish()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    // the entries are collected first as the map may change while the lock is released
+    std::vector<EntryPtr> entries;
+    for (auto& bucket : m_pipelines)
+    {
+        for (auto& entry : bucket.second)
+        {
+            if (!entry->pipeline)
+                entries.push_back(entry);
+        }
+    }
+    for (const EntryPtr& entry : entries)
+    {
+        if (!entry->pipeline && !entry->failed)
+            wait(*entry, lock);
+    }
+}
+
+void RenderPipelineCache::clear()
+{
+    finish();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pipelines.clear();
+    m_pipelineCount = 0;
+}
+
+RenderPipelineCache::EntryPtr RenderPipelineCache::find(const Key& key, size_t seed)
+{
+    auto found = m_pipelines.find(seed);
+    if (found == m_pipelines.end())
+        return nullptr;
+
+    for (auto& entry : found->second)
+    {
+        if (entry->key == key)
+            return entry;
+    }
+    return nullptr;
+}
+
+RenderPipelineCache::EntryPtr RenderPipelineCache::insert(Key&& key, size_t seed)
+{
+    EntryPtr entry = std::make_shared<Entry>();
+    entry->key     = std::move(key);
+    entry->seed    = seed;
+
+    m_pipelines[seed].push_back(entry);
+    ++m_pipelineCount;
+    return entry;
+}
+
+bool RenderPipelineCache::wait(Entry& entry, std::unique_lock<std::mutex>& lock)
+{
+    assert(!entry.pipeline);
+    if (!entry.pending.valid())
+    {
+        // created or waited by another thread
+        m_ready.wait(lock, [&entry]() { return entry.pipeline || entry.failed; });
+        return !entry.failed;
+    }
+
+    // the future is taken, so the other threads wait for the condition instead
+    PipelineBuilder::Future<RenderPipeline> pending = std::move(entry.pending);
+    lock.unlock();
+    pending.wait();
+    lock.lock();
+    return resolve(entry, pending);
+}
+
+bool RenderPipelineCache::resolve(Entry& entry, PipelineBuilder::Future<RenderPipeline>& pending)
+{
+    --m_pendingCount;
+    try
+    {
+        entry.pipeline = pending.get();
+    }
+    catch (...)
+    {
+        // the next get() or request() of the state creates it again
+        discard(entry);
+        return false;
+    }
+
+    const double pendingTime = std::chrono::duration<double, std::milli>(Clock::now() - entry.requestTime).count();
+    m_statistics.maxPendingTime = std::max(m_statistics.maxPendingTime, pendingTime);
+    m_ready.notify_all();
+    return true;
+}
+
+void RenderPipelineCache::discard(Entry& entry)
+{
+    entry.failed = true;
+
+    auto found = m_pipelines.find(entry.seed);
+    if (found != m_pipelines.end())
+    {
+        auto& bucket = found->second;
+        auto  it     = std::find_if(bucket.begin(), bucket.end(),
+                               [&entry](const EntryPtr& other) { return other.get() == &entry; });
+        if (it != bucket.end())
+        {
+            bucket.erase(it);
+            --m_pipelineCount;
+        }
+        if (bucket.empty())
+            m_pipelines.erase(found);
+    }
+    m_ready.notify_all();
+}
+
+void RenderPipelineCache::addStall(Clock::time_point start)
+{
+    const double stall = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    m_statistics.stallTime += stall;
+    m_statistics.maxStall = std::max(m_statistics.maxStall, stall);
+}
+
+size_t RenderPipelineCache::hash(const RenderPass& pass, const ShaderPipeline& shaderPipeline,
+                                 const RenderPipeline::CreateParams&  params,
+                                 const RenderPipeline::ViewportParam& viewportParam)
+{
+    return hashKey(makeKey(pass, shaderPipeline, params, viewportParam));
+}
+
+RenderPipelineCache::Key RenderPipelineCache::makeKey(const RenderPass& pass, const ShaderPipeline& shaderPipeline,
+                                                      const RenderPipeline::CreateParams&  params,
+                                                      const RenderPipeline::ViewportParam& viewportParam)
+{
+    Key key;
+    key.reserve(128);
+
+    // render pass compatibility, the load/store operations don't matter and the depth attachment selects the state
+    append(key, pass.subpassCount());
+    append(key, (uint32_t)pass.attachments().size());
+    for (const auto& attachment : pass.attachments())
+    {
+        append(key, (uint32_t)attachment.format.get());
+        append(key, attachment.samples);
+        append(key, attachment.layout == TextureLayoutType::eDepthStencilOptimal);
+    }
+
+    const auto& stageInfos = detail::getStageCreateInfos(shaderPipeline);
+    append(key, (uint32_t)stageInfos.size());
+    for (const auto& stageInfo : stageInfos)
+    {
+        append(key, (uint32_t)stageInfo.stage);
+        appendHandle(key, (uint64_t)stageInfo.module);
+        const size_t nameLength = std::strlen(stageInfo.pName);
+        append(key, (uint32_t)nameLength);
+        for (size_t i = 0; i < nameLength; ++i)
+            append(key, (uint32_t)stageInfo.pName[i]);
+
+        const VkSpecializationInfo* specialization = stageInfo.pSpecializationInfo;
+        append(key, specialization ? specialization->mapEntryCount : 0u);
+        if (!specialization)
+            continue;
+        for (uint32_t i = 0; i < specialization->mapEntryCount; ++i)
+        {
+            const auto& entry = specialization->pMapEntries[i];
+            append(key, entry.constantID);
+            append(key, entry.offset);
+            append(key, (uint32_t)entry.size);
+        }
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(specialization->pData);
+        append(key, (uint32_t)specialization->dataSize);
+        for (size_t i = 0; i < specialization->dataSize; ++i)
+            append(key, (uint32_t)data[i]);
+    }
+
+    // the declaration order of the dynamic states doesn't change the pipeline
+    std::vector<uint32_t> dynamicStates;
+    dynamicStates.reserve(params.dynamicStates.size());
+    for (const auto state : params.dynamicStates)
+        dynamicStates.push_back((uint32_t)state.get());
+    std::sort(dynamicStates.begin(), dynamicStates.end());
+    append(key, (uint32_t)dynamicStates.size());
+    key.insert(key.end(), dynamicStates.begin(), dynamicStates.end());
+    if (!hasDynamicState(params, DynamicState::eViewport) || !hasDynamicState(params, DynamicState::eScissor))
+    {
+        append(key, viewportParam.viewportSize.width);
+        append(key, viewportParam.viewportSize.height);
+        append(key, viewportParam.viewportX);
+        append(key, viewportParam.viewportY);
+    }
+
+    if (params.vertexDescription)
+    {
+        const auto& bindings = detail::getBindingDescriptions(*params.vertexDescription);
+        append(key, (uint32_t)bindings.size());
+        for (const auto& binding : bindings)
+        {
+            append(key, binding.binding);
+            append(key, binding.stride);
+            append(key, (uint32_t)binding.inputRate);
+        }
+        const auto& attributes = detail::getAttributeDescriptons(*params.vertexDescription);
+        append(key, (uint32_t)attributes.size());
+        for (const auto& attribute : attributes)
+        {
+            append(key, attribute.location);
+            append(key, attribute.binding);
+            append(key, (uint32_t)attribute.format);
+            append(key, attribute.offset);
+        }
+    }
+    else
+        append(key, 0u);
+
+    append(key, (uint32_t)params.descriptorLayouts.size());
+    for (const auto layout : params.descriptorLayouts)
+        appendHandle(key, (uint64_t)layout);
+    append(key, (uint32_t)params.pushConstants.size());
+    for (const auto& range : params.pushConstants)
+    {
+        append(key, (uint32_t)range.stages.get());
+        append(key, range.offset);
+        append(key, range.size);
+    }
+
+    // the static values of the dynamic states are ignored, permutations of them share the same pipeline
+    const auto isStatic = [&params](DynamicState state) { return !hasDynamicState(params, state); };
+
+    if (isStatic(DynamicState::ePrimitiveTopology))
+        append(key, (uint32_t)params.primitiveTopology.get());
+    else
+        append(key, topologyClass(params.primitiveTopology));
+    if (isStatic(DynamicState::ePrimitiveRestartEnable))
+        append(key, params.primitiveRestart);
+    if (isStatic(DynamicState::eLineWidth))
+        append(key, params.lineWidth);
+    if (isStatic(DynamicState::eCullMode))
+        append(key, (uint32_t)params.cullMode.get());
+    if (isStatic(DynamicState::eFrontFace))
+        append(key, params.frontFaceCW);
+    if (isStatic(DynamicState::ePolygonMode))
+        append(key, (uint32_t)params.polygonMode.get());
+    if (isStatic(DynamicState::eColorWriteMask))
+        append(key, params.colorWriteEnable);
+    if (isStatic(DynamicState::eRasterizerDiscardEnable))
+        append(key, params.rasterizeEnable);
+
+    if (isStatic(DynamicState::eColorBlendEnable))
+        append(key, params.blend);
+    append(key, (uint32_t)params.blendSrcFactor.get());
+    append(key, (uint32_t)params.blendDstFactor.get());
+    append(key, (uint32_t)params.blendOperation.get());
+    append(key, (uint32_t)params.blendAlphaSrcFactor.get());
+    append(key, (uint32_t)params.blendAlphaDstFactor.get());
+    append(key, (uint32_t)params.blendAlphaOperation.get());
+
+    if (isStatic(DynamicState::eDepthTestEnable))
+        append(key, params.depthTestEnable);
+    if (isStatic(DynamicState::eDepthWriteEnable))
+        append(key, params.depthWriteEnable);
+    if (isStatic(DynamicState::eDepthClampEnable))
+        append(key, params.depthClampEnable);
+    if (isStatic(DynamicState::eDepthBiasEnable))
+        append(key, params.depthBiasEnable);
+    if (isStatic(DynamicState::eDepthBias))
+    {
+        append(key, params.depthBiasConstantFactor);
+        append(key, params.depthBiasClamp);
+        append(key, params.depthBiasSlopeFactor);
+    }
+    if (isStatic(DynamicState::eDepthBoundsTestEnable))
+        append(key, params.depthBoundsTestEnable);
+    append(key, params.depthMinBounds);
+    append(key, params.depthMaxBounds);
+    if (isStatic(DynamicState::eDepthCompareOp))
+        append(key, (uint32_t)params.depthCompareOp.get());
+
+    if (isStatic(DynamicState::eStencilTestEnable))
+        append(key, params.stencilTestEnable);
+    append(key, params.stencilFrontState, params);
+    append(key, params.stencilBackState, params);
+
+    append(key, params.sampleShadingEnable);
+    append(key, params.minSampleShading);
+    append(key, params.rasterizationSamples);
+
+    if (isStatic(DynamicState::ePatchControlPoints))
+        append(key, params.tesselationPatchControlPoints);
+    append(key, params.activeSubpassIndex);
+    append(key, params.allowDerivatives);
+    // the pipeline derivatives are only a creation hint and don't change the pipeline
+
+    return key;
+}
+
+size_t RenderPipelineCache::hashKey(const Key& key)
+{
+    size_t seed = key.size();
+    for (const auto word : key)
+        hashCombine(seed, word);
+    return seed;
+}
+
+}  // namespace ri
@@ -0,0 +1,76 @@
+
+#include <ri/RenderPipelineLibrary.h>
+
+#include <ri/DeviceContext.h>
+#include <ri/PipelineCache.h>
+#include <ri/ShaderPipeline.h>
+
+namespace ri
+{
+RenderPipelineLibrary::RenderPipelineLibrary(const ri::DeviceContext&             device,          //
+                                             const ri::RenderPass&                pass,            //
+                                             const ri::ShaderPipeline&            shaderPipeline,  //
+                                             const RenderPipeline::CreateParams&  params,          //
+                                             int                                  parts,           //
+                                             const RenderPipeline::ViewportParam& viewportParam)
+    : m_device(detail::getVkHandle(device))
+    , m_parts(parts)
+{
+    assert(parts && (parts & ~eAll) == 0);
+
+    const RenderPipeline::PipelineCreateData data(pass, params, viewportParam);
+    m_viewport       = data.viewport;
+    m_scissor        = data.scissor;
+    m_pipelineLayout = RenderPipeline::createLayout(device, params, params.descriptorLayouts);
+
+    VkGraphicsPipelineCreateInfo info =
+        RenderPipeline::getPipelineCreateInfo(pass, shaderPipeline, params, data, m_pipelineLayout);
+
+    // keep only the stages and states of the library parts
+    std::vector<VkPipelineShaderStageCreateInfo> stageInfos;
+    for (const auto& stageInfo : detail::getStageCreateInfos(shaderPipeline))
+    {
+        const int stagePart = stageInfo.stage == VK_SHADER_STAGE_FRAGMENT_BIT ? eFragmentShader : ePreRasterization;
+        if (parts & stagePart)
+            stageInfos.push_back(stageInfo);
+    }
+    info.stageCount = stageInfos.size();
+    info.pStages    = stageInfos.data();
+    if (!(parts & eVertexInput))
+    {
+        info.pVertexInputState   = nullptr;
+        info.pInputAssemblyState = nullptr;
+    }
+    if (!(parts & ePreRasterization))
+    {
+        info.pViewportState      = nullptr;
+        info.pRasterizationState = nullptr;
+        info.pTessellationState  = nullptr;
+    }
+    if (!(parts & eFragmentShader))
+        info.pDepthStencilState = nullptr;
+    if (!(parts & (eFragmentShader | eFragmentOutput)))
+        info.pMultisampleState = nullptr;
+    if (!(parts & eFragmentOutput))
+        info.pColorBlendState = nullptr;
+
+    // the retained info allows an optimized link
+    info.flags = VK_PIPELINE_CREATE_LIBRARY_BIT_KHR | VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT;
+    info.basePipelineHandle = VK_NULL_HANDLE;
+    info.basePipelineIndex  = -1;
+
+    VkGraphicsPipelineLibraryCreateInfoEXT libraryInfo = {VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT};
+    libraryInfo.flags                                  = (VkGraphicsPipelineLibraryFlagsEXT)parts;
+    info.pNext                                         = &libraryInfo;
+
+    RI_CHECK_RESULT_MSG("couldn't create render pipeline library") =
+        vkCreateGraphicsPipelines(m_device, detail::getVkHandle(device.pipelineCache()), 1, &info, nullptr, &m_handle);
+}
+
+RenderPipelineLibrary::~RenderPipelineLibrary()
+{
+    vkDestroyPipeline(m_device, m_handle, nullptr);
+    // the layout is owned by the device's pipeline layout cache
+}
+
+}  // namespace ri
@@ -0,0 +1,143 @@
+
+#include <ri/RenderQueue.h>
+
+#include <cstring>
+#include <utility>
+#include <ri/CommandRecorder.h>
+#include <ri/DescriptorSet.h>
+#include <ri/RenderPipeline.h>
+#include <ri/VertexDescription.h>
+
+namespace ri
+{
+void RenderQueue::submit(uint64_t key, const DrawPacket& packet, const void* pushData /*= nullptr*/)
+{
+    assert(packet.pipeline);
+    assert((packet.vertexDescription != nullptr) != (packet.indexedVertexDescription != nullptr));
+    assert(packet.count);
+    assert(!packet.pushSize || pushData);
+
+    const uint32_t packetIndex = static_cast<uint32_t>(m_packets.size());
+    m_packets.push_back(packet);
+    m_entries.push_back(Entry({key, packetIndex}));
+
+    m_pushDataOffsets.push_back(static_cast<uint32_t>(m_pushData.size()));
+    if (packet.pushSize)
+    {
+        const uint8_t* data = static_cast<const uint8_t*>(pushData);
+        m_pushData.insert(m_pushData.end(), data, data + packet.pushSize);
+    }
+    m_sorted = false;
+}
+
+void RenderQueue::sort()
+{
+    if (m_sorted)
+        return;
+
+    radixSort(m_entries, m_scratch);
+    m_sorted = true;
+}
+
+void RenderQueue::replay(CommandBuffer& buffer) const
+{
+    CommandRecorder recorder(buffer);
+    replay(recorder);
+}
+
+void RenderQueue::replay(CommandRecorder& recorder) const
+{
+    assert(m_sorted);
+
+    for (const Entry& entry : m_entries)
+    {
+        const DrawPacket& packet = m_packets[entry.packetIndex];
+
+        recorder.bind(*packet.pipeline);
+        for (uint32_t i = 0; i < kMaxDescriptorSets && packet.descriptorSets[i]; ++i)
+        {
+            const uint32_t offsetCount = (packet.dynamicOffsetMask >> i) & 1;
+            recorder.bind(*packet.descriptorSets[i], *packet.pipeline, i, &packet.dynamicOffsets[i], offsetCount);
+        }
+        if (packet.pushSize)
+        {
+            recorder.pushConstants(*packet.pipeline, packet.pushStages,
+                                   m_pushData.data() + m_pushDataOffsets[entry.packetIndex], packet.pushOffset,
+                                   packet.pushSize);
+        }
+
+        if (packet.indexedVertexDescription)
+        {
+            recorder.bind(*packet.indexedVertexDescription);
+            recorder.drawIndexed(packet.count, packet.instanceCount, packet.first, packet.vertexOffset,
+                                 packet.firstInstance);
+        }
+        else
+        {
+            recorder.bind(*packet.vertexDescription);
+            recorder.draw(packet.count, packet.instanceCount, packet.first, packet.firstInstance);
+        }
+    }
+}
+
+void RenderQueue::clear()
+{
+    m_packets.clear();
+    m_pushDataOffsets.clear();
+    m_pushData.clear();
+    m_entries.clear();
+    m_sorted = true;
+}
+
+void RenderQueue::radixSort(std::vector<Entry>& entries, std::vector<Entry>& scratch)
+{
+    // least significant digit first, stable on each pass
+    const size_t kRadixBits = 8;
+    const size_t kRadixSize = 1 << kRadixBits;
+    const size_t kPassCount = sizeof(uint64_t) * 8 / kRadixBits;
+    const size_t entryCount = entries.size();
+    if (entryCount < 2)
+        return;
+
+    // histograms for all passes are gathered in a single read
+    uint32_t histograms[kPassCount][kRadixSize];
+    std::memset(histograms, 0, sizeof(histograms));
+    for (const Entry& entry : entries)
+    {
+        for (size_t pass = 0; pass < kPassCount; ++pass)
+            ++histograms[pass][(entry.key >> (pass * kRadixBits)) & (kRadixSize - 1)];
+    }
+
+    scratch.resize(entryCount);
+    Entry* src = entries.data();
+    Entry* dst = scratch.data();
+    for (size_t pass = 0; pass < kPassCount; ++pass)
+    {
+        uint32_t*    histogram = histograms[pass];
+        const size_t shift     = pass * kRadixBits;
+
+        // all the keys have the same digit, nothing to reorder
+        if (histogram[(src[0].key >> shift) & (kRadixSize - 1)] == entryCount)
+            continue;
+
+        uint32_t offset = 0;
+        for (size_t i = 0; i < kRadixSize; ++i)
+        {
+            const uint32_t count = histogram[i];
+            histogram[i]         = offset;
+            offset += count;
+        }
+
+        for (size_t i = 0; i < entryCount; ++i)
+        {
+            const Entry& entry = src[i];
+            dst[histogram[(entry.key >> shift) & (kRadixSize - 1)]++] = entry;
+        }
+        std::swap(src, dst);
+    }
+
+    if (src != entries.data())
+        entries.swap(scratch);
+}
+
+}  // namespace ri
@@ -1,7 +1,7 @@
 
 #include <ri/ShaderModule.h>
 
-#include <fstream>
+#include <util/mapped_file.h>
 
 namespace ri
 {
@@ -9,28 +9,18 @@ ShaderModule::ShaderModule(const DeviceContext& device, const std::string& filen
     : m_device(detail::getVkHandle(device))
     , m_stage(stage)
 {
-    std::ifstream file(filename + ".spv", std::ios::ate | std::ios::binary);
-    assert(file.is_open());
+    // the code is read straight from the mapping, the module creation copies it
+    const util::MappedFile file(filename + ".spv");
+    assert(file.isOpen());
 
-#ifdef NDEBUG
-    std::vector<char> code((size_t)file.tellg());
-#else
-    m_code.resize((size_t)file.tellg());
-    auto& code = m_code;
-#endif
-
-    file.seekg(0);
-    file.read(code.data(), code.size());
-    file.close();
-
-    VkShaderModuleCreateInfo createInfo = {};
-
-    createInfo.sType    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    createInfo.codeSize = code.size();
-    createInfo.pCode    = reinterpret_cast<const uint32_t*>(code.data());
+    create(static_cast<const uint32_t*>(file.data()), file.size());
+}
 
-    RI_CHECK_RESULT_MSG("couldn't create shader module") =
-        vkCreateShaderModule(m_device, &createInfo, nullptr, &m_handle);
+ShaderModule::ShaderModule(const DeviceContext& device, const uint32_t* code, size_t codeSize, ShaderStage stage)
+    : m_device(detail::getVkHandle(device))
+    , m_stage(stage)
+{
+    create(code, codeSize);
 }
 
 ShaderModule::~ShaderModule()
@@ -39,31 +29,20 @@ ShaderModule::~ShaderModule()
     vkDestroyShaderModule(m_device, m_handle, nullptr);
 }
 
-#ifndef NDEBUG
-// O(m*n), no need for speed
-const char* sstrstr(const char* haystack, const char* needle, size_t length)
+void ShaderModule::create(const uint32_t* code, size_t codeSize)
 {
-    size_t needle_length = strlen(needle);
-    size_t i;
+    assert(code && codeSize % sizeof(uint32_t) == 0);
 
-    for (i = 0; i < length; i++)
-    {
-        if (i + needle_length > length)
-            return NULL;
+    VkShaderModuleCreateInfo createInfo = {};
 
-        if (strncmp(&haystack[i], needle, needle_length) == 0)
-            return &haystack[i];
-    }
-    return NULL;
-}
+    createInfo.sType    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    createInfo.codeSize = codeSize;
+    createInfo.pCode    = code;
 
-bool ShaderModule::hasProcedure(const std::string& name) const
-{
-    assert(!m_code.empty());
-    std::string t     = m_code.data();
-    auto        found = sstrstr(m_code.data(), name.c_str(), m_code.size());
-    // TODO: also check if spir-v procedure
-    return found != nullptr;
+    RI_CHECK_RESULT_MSG("couldn't create shader module") =
+        vkCreateShaderModule(m_device, &createInfo, nullptr, &m_handle);
+
+    m_reflection = ShaderReflection(code, codeSize / sizeof(uint32_t), m_stage);
+    assert(m_reflection.valid());
 }
-#endif
 }  // namespace ri
@@ -0,0 +1,104 @@
+
+#include <ri/ShaderModuleCache.h>
+
+#include <algorithm>
+#include <util/mapped_file.h>
+#include <ri/ShaderModule.h>
+
+namespace ri
+{
+ShaderModuleCache::ShaderModuleCache(const DeviceContext& device)
+    : m_device(device)
+{
+}
+
+ShaderModuleCache::~ShaderModuleCache()
+{
+}
+
+ShaderModuleCache::SharedModule ShaderModuleCache::get(const std::string& filename, ShaderStage stage)
+{
+    const util::MappedFile file(filename + ".spv");
+    if (!file.isOpen())
+        return nullptr;
+
+    const uint64_t hash = hashCode(file.data(), file.size());
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (SharedModule module = find(filename, hash, stage))
+            return module;
+    }
+
+    // created outside of the lock from the mapping, without an intermediate copy of the code
+    SharedModule module =
+        std::make_shared<const ShaderModule>(m_device, static_cast<const uint32_t*>(file.data()), file.size(), stage);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // another thread may have created the same module meanwhile, its module wins and this one is destroyed
+    if (SharedModule existing = find(filename, hash, stage))
+        return existing;
+    m_modules[filename].push_back(Entry({hash, stage, module}));
+    ++m_moduleCount;
+    return module;
+}
+
+ShaderModuleCache::SharedModule ShaderModuleCache::find(const std::string& filename, uint64_t hash,
+                                                        ShaderStage stage) const
+{
+    auto found = m_modules.find(filename);
+    if (found == m_modules.end())
+        return nullptr;
+
+    for (const auto& entry : found->second)
+    {
+        if (entry.hash == hash && entry.stage == stage)
+            return entry.module;
+    }
+    return nullptr;
+}
+
+size_t ShaderModuleCache::releaseUnused()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    size_t released = 0;
+    for (auto it = m_modules.begin(); it != m_modules.end();)
+    {
+        auto& entries = it->second;
+        auto  unused  = std::remove_if(entries.begin(), entries.end(),
+                                     [](const Entry& entry) { return entry.module.use_count() == 1; });
+        released += std::distance(unused, entries.end());
+        entries.erase(unused, entries.end());
+
+        if (entries.empty())
+            it = m_modules.erase(it);
+        else
+            ++it;
+    }
+    m_moduleCount -= released;
+    return released;
+}
+
+void ShaderModuleCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_modules.clear();
+    m_moduleCount = 0;
+}
+
+uint64_t ShaderModuleCache::hashCode(const void* data, size_t size)
+{
+    // FNV-1a over the words, the SPIR-V code is a multiple of 4 bytes
+    const uint64_t  kPrime = 1099511628211ull;
+    uint64_t        hash   = 14695981039346656037ull;
+    const uint32_t* words  = static_cast<const uint32_t*>(data);
+    for (size_t i = 0; i < size / sizeof(uint32_t); ++i)
+    {
+        hash ^= words[i];
+        hash *= kPrime;
+    }
+    hash ^= size;
+    return hash * kPrime;
+}
+
+}  // namespace ri
@@ -0,0 +1,708 @@
+
+#include <ri/ShaderReflection.h>
+
+#include <algorithm>
+#include <map>
+
+namespace ri
+{
+namespace
+{
+    // subset of the SPIR-V specification used by the reflection
+    const uint32_t kSpirvMagic      = 0x07230203;
+    const uint32_t kSpirvHeaderSize = 5;
+
+    enum Opcode
+    {
+        eOpName                  = 5,
+        eOpEntryPoint            = 15,
+        eOpExecutionMode         = 16,
+        eOpTypeBool              = 20,
+        eOpTypeInt               = 21,
+        eOpTypeFloat             = 22,
+        eOpTypeVector            = 23,
+        eOpTypeMatrix            = 24,
+        eOpTypeImage             = 25,
+        eOpTypeSampler           = 26,
+        eOpTypeSampledImage      = 27,
+        eOpTypeArray             = 28,
+        eOpTypeRuntimeArray      = 29,
+        eOpTypeStruct            = 30,
+        eOpTypePointer           = 32,
+        eOpConstant              = 43,
+        eOpConstantComposite     = 44,
+        eOpSpecConstant          = 50,
+        eOpSpecConstantComposite = 51,
+        eOpVariable              = 59,
+        eOpDecorate              = 71,
+        eOpMemberDecorate        = 72,
+        eOpExecutionModeId       = 331
+    };
+
+    enum Decoration
+    {
+        eDecorationSpecId        = 1,
+        eDecorationBufferBlock   = 3,
+        eDecorationArrayStride   = 6,
+        eDecorationBuiltIn       = 11,
+        eDecorationLocation      = 30,
+        eDecorationBinding       = 33,
+        eDecorationDescriptorSet = 34,
+        eDecorationOffset        = 35
+    };
+
+    enum StorageClass
+    {
+        eStorageUniformConstant = 0,
+        eStorageInput           = 1,
+        eStorageUniform         = 2,
+        eStoragePushConstant    = 9,
+        eStorageStorageBuffer   = 12
+    };
+
+    const uint32_t kExecutionModeLocalSize   = 17;
+    const uint32_t kExecutionModeLocalSizeId = 38;
+    const uint32_t kBuiltInWorkgroupSize     = 25;
+    const uint32_t kImageDimBuffer           = 5;
+    const uint32_t kImageDimSubpassData      = 6;
+    // nesting of the types whose size is computed
+    const uint32_t kMaxTypeDepth = 64;
+    // above any device's maxBoundDescriptorSets, the layouts are indexed by set
+    const int kMaxDescriptorSets = 32;
+
+    struct Id
+    {
+        // the instruction that defines the id
+        const uint32_t* words     = nullptr;
+        uint32_t        wordCount = 0;
+        std::string     name;
+
+        int  set         = -1;
+        int  binding     = -1;
+        int  location    = -1;
+        int  specId      = -1;
+        int  builtIn     = -1;
+        bool bufferBlock = false;
+
+        uint32_t              arrayStride = 0;
+        std::vector<uint32_t> memberOffsets;
+
+        uint32_t opcode() const
+        {
+            return words ? (words[0] & 0xffff) : 0;
+        }
+        /// @return 0 if the instruction is too short, e.g. malformed code.
+        uint32_t word(uint32_t index) const
+        {
+            return index < wordCount ? words[index] : 0;
+        }
+    };
+
+    std::string readString(const uint32_t* words, uint32_t wordCount, uint32_t& stringWords)
+    {
+        const char* chars  = reinterpret_cast<const char*>(words);
+        const auto  length = std::find(chars, chars + wordCount * 4, '\0') - chars;
+        stringWords        = (uint32_t)length / 4 + 1;
+        return std::string(chars, length);
+    }
+
+    bool stageFrom(uint32_t executionModel, ShaderStage& result)
+    {
+        switch (executionModel)
+        {
+            case 0:
+                result = ShaderStage::eVertex;
+                return true;
+            case 1:
+                result = ShaderStage::eTessellationControl;
+                return true;
+            case 2:
+                result = ShaderStage::eTessellationEvaluation;
+                return true;
+            case 3:
+                result = ShaderStage::eGeometry;
+                return true;
+            case 4:
+                result = ShaderStage::eFragment;
+                return true;
+            case 5:
+                result = ShaderStage::eCompute;
+                return true;
+            default:
+                // ray tracing and mesh stages aren't supported
+                return false;
+        }
+    }
+
+    class Parser
+    {
+    public:
+        Parser(const uint32_t* code, size_t wordCount)
+            : m_code(code)
+            , m_wordCount(wordCount)
+        {
+        }
+
+        bool parse()
+        {
+            if (!m_code || m_wordCount < kSpirvHeaderSize || m_code[0] != kSpirvMagic)
+                return false;
+
+            // every id is defined by an instruction, a larger bound is malformed
+            if (m_code[3] > m_wordCount)
+                return false;
+            m_ids.resize(m_code[3]);
+            size_t offset = kSpirvHeaderSize;
+            while (offset < m_wordCount)
+            {
+                const uint32_t* words     = m_code + offset;
+                const uint32_t  wordCount = words[0] >> 16;
+                if (!wordCount || offset + wordCount > m_wordCount)
+                    return false;
+                if (!parseInstruction(words, wordCount))
+                    return false;
+                offset += wordCount;
+            }
+            return true;
+        }
+
+        const std::vector<const uint32_t*>& entryPoints() const
+        {
+            return m_entryPoints;
+        }
+        const std::vector<const uint32_t*>& executionModes() const
+        {
+            return m_executionModes;
+        }
+        const std::vector<uint32_t>& variables() const
+        {
+            return m_variables;
+        }
+        const std::vector<uint32_t>& workgroupSizes() const
+        {
+            return m_workgroupSizes;
+        }
+
+        const Id& id(uint32_t index) const
+        {
+            static const Id kInvalid;
+            return index < m_ids.size() ? m_ids[index] : kInvalid;
+        }
+
+        uint32_t constant(uint32_t index) const
+        {
+            const Id& constantId = id(index);
+            const auto opcode    = constantId.opcode();
+            if ((opcode == eOpConstant || opcode == eOpSpecConstant) && constantId.wordCount > 3)
+                return constantId.words[3];
+            return 0;
+        }
+
+        /// Strips the arrays from the type, the count is the product of their lengths or 0 if runtime sized.
+        uint32_t elementType(uint32_t type, uint32_t& count) const
+        {
+            count = 1;
+            // bounded, malformed code may have cyclic types
+            for (size_t depth = 0; depth < m_ids.size(); ++depth)
+            {
+                const Id& typeId = id(type);
+                if (typeId.opcode() == eOpTypeArray)
+                    count *= constant(typeId.word(3));
+                else if (typeId.opcode() == eOpTypeRuntimeArray)
+                    count = 0;
+                else
+                    return type;
+                type = typeId.word(2);
+            }
+            return 0;
+        }
+
+        /// Size of the type with the std140/std430 alignment of matrix columns.
+        uint32_t typeSize(uint32_t type, uint32_t depth = 0) const
+        {
+            // malformed code may have cyclic types
+            if (depth > kMaxTypeDepth)
+                return 0;
+            const Id& typeId = id(type);
+            switch (typeId.opcode())
+            {
+                case eOpTypeBool:
+                    return 4;
+                case eOpTypeInt:
+                case eOpTypeFloat:
+                    return typeId.word(2) / 8;
+                case eOpTypeVector:
+                    return typeSize(typeId.word(2), depth + 1) * typeId.word(3);
+                case eOpTypeMatrix:
+                {
+                    const Id&      column     = id(typeId.word(2));
+                    const uint32_t components = column.word(3) == 3 ? 4 : column.word(3);
+                    return typeSize(column.word(2), depth + 1) * components * typeId.word(3);
+                }
+                case eOpTypeArray:
+                {
+                    const uint32_t stride =
+                        typeId.arrayStride ? typeId.arrayStride : typeSize(typeId.word(2), depth + 1);
+                    return stride * constant(typeId.word(3));
+                }
+                case eOpTypeStruct:
+                {
+                    uint32_t size = 0;
+                    for (uint32_t i = 2; i < typeId.wordCount; ++i)
+                    {
+                        const uint32_t member = i - 2;
+                        const uint32_t offset =
+                            member < typeId.memberOffsets.size() ? typeId.memberOffsets[member] : size;
+                        size = std::max(size, offset + typeSize(typeId.word(i), depth + 1));
+                    }
+                    return size;
+                }
+                default:
+                    return 0;
+            }
+        }
+
+    private:
+        bool parseInstruction(const uint32_t* words, uint32_t wordCount)
+        {
+            switch (words[0] & 0xffff)
+            {
+                case eOpName:
+                    if (wordCount < 3 || !valid(words[1]))
+                        return false;
+                    uint32_t stringWords;
+                    m_ids[words[1]].name = readString(words + 2, wordCount - 2, stringWords);
+                    break;
+                case eOpEntryPoint:
+                    if (wordCount < 4)
+                        return false;
+                    m_entryPoints.push_back(words);
+                    break;
+                case eOpExecutionMode:
+                case eOpExecutionModeId:
+                    if (wordCount < 3)
+                        return false;
+                    m_executionModes.push_back(words);
+                    break;
+                case eOpDecorate:
+                    if (wordCount < 3 || !valid(words[1]))
+                        return false;
+                    decorate(m_ids[words[1]], words[1], words[2], wordCount > 3 ? words[3] : 0);
+                    break;
+                case eOpMemberDecorate:
+                {
+                    if (wordCount < 4 || !valid(words[1]))
+                        return false;
+                    auto&          type   = m_ids[words[1]];
+                    const uint32_t member = words[2];
+                    if (words[3] == eDecorationOffset && wordCount > 4)
+                    {
+                        // a struct can't have more members than the module's words
+                        if (member >= m_wordCount)
+                            return false;
+                        if (type.memberOffsets.size() <= member)
+                            type.memberOffsets.resize(member + 1, 0);
+                        type.memberOffsets[member] = words[4];
+                    }
+                    break;
+                }
+                case eOpTypeBool:
+                case eOpTypeInt:
+                case eOpTypeFloat:
+                case eOpTypeVector:
+                case eOpTypeMatrix:
+                case eOpTypeImage:
+                case eOpTypeSampler:
+                case eOpTypeSampledImage:
+                case eOpTypeArray:
+                case eOpTypeRuntimeArray:
+                case eOpTypeStruct:
+                case eOpTypePointer:
+                    return define(words, wordCount, 1, 2);
+                case eOpConstant:
+                case eOpConstantComposite:
+                case eOpSpecConstant:
+                case eOpSpecConstantComposite:
+                    return define(words, wordCount, 2, 3);
+                case eOpVariable:
+                    if (!define(words, wordCount, 2, 4))
+                        return false;
+                    m_variables.push_back(words[2]);
+                    break;
+                default:
+                    break;
+            }
+            return true;
+        }
+
+        ///@param resultWord Index of the result id's word.
+        bool define(const uint32_t* words, uint32_t wordCount, uint32_t resultWord, uint32_t minWordCount)
+        {
+            if (wordCount < minWordCount)
+                return false;
+            const uint32_t index = words[resultWord];
+            if (!valid(index))
+                return false;
+            m_ids[index].words     = words;
+            m_ids[index].wordCount = wordCount;
+            return true;
+        }
+
+        void decorate(Id& target, uint32_t index, uint32_t decoration, uint32_t value)
+        {
+            switch (decoration)
+            {
+                case eDecorationSpecId:
+                    target.specId = value;
+                    break;
+                case eDecorationBufferBlock:
+                    target.bufferBlock = true;
+                    break;
+                case eDecorationArrayStride:
+                    target.arrayStride = value;
+                    break;
+                case eDecorationBuiltIn:
+                    target.builtIn = value;
+                    if (value == kBuiltInWorkgroupSize)
+                        m_workgroupSizes.push_back(index);
+                    break;
+                case eDecorationLocation:
+                    target.location = value;
+                    break;
+                case eDecorationBinding:
+                    target.binding = value;
+                    break;
+                case eDecorationDescriptorSet:
+                    target.set = value;
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        bool valid(uint32_t index) const
+        {
+            return index < m_ids.size();
+        }
+
+    private:
+        const uint32_t*              m_code;
+        size_t                       m_wordCount;
+        std::vector<Id>              m_ids;
+        std::vector<const uint32_t*> m_entryPoints;
+        std::vector<const uint32_t*> m_executionModes;
+        std::vector<uint32_t>        m_variables;
+        std::vector<uint32_t>        m_workgroupSizes;
+    };
+
+    bool descriptorType(const Parser& parser, uint32_t storageClass, uint32_t type, DescriptorType& result)
+    {
+        const Id& typeId = parser.id(type);
+        switch (typeId.opcode())
+        {
+            case eOpTypeSampler:
+                result = DescriptorType::eSampler;
+                return true;
+            case eOpTypeSampledImage:
+                result = DescriptorType::eCombinedSampler;
+                return true;
+            case eOpTypeImage:
+            {
+                const uint32_t dim     = typeId.word(3);
+                const uint32_t sampled = typeId.word(7);
+                if (dim == kImageDimSubpassData)
+                    return false;  // input attachments aren't supported
+                if (dim == kImageDimBuffer)
+                    result = sampled == 2 ? DescriptorType::eTexelBuffer : DescriptorType::eUniformTexelBuffer;
+                else
+                    result = sampled == 2 ? DescriptorType::eImage : DescriptorType::eSampledImage;
+                return true;
+            }
+            case eOpTypeStruct:
+                if (storageClass == eStorageStorageBuffer || typeId.bufferBlock)
+                    result = DescriptorType::eStorageBuffer;
+                else
+                    result = DescriptorType::eUniformBuffer;
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    bool attributeFormat(const Parser& parser, uint32_t type, AttributeFormat& result)
+    {
+        const Id& typeId     = parser.id(type);
+        uint32_t  components = 1;
+        uint32_t  scalar     = type;
+        if (typeId.opcode() == eOpTypeVector)
+        {
+            scalar     = typeId.word(2);
+            components = typeId.word(3);
+        }
+        const Id& scalarId = parser.id(scalar);
+        if (components < 1 || components > 4 || scalarId.wordCount < 3)
+            return false;
+
+        static const AttributeFormat::type kHalfFloats[] = {AttributeFormat::eHalfFloat, AttributeFormat::eHalfFloat2,
+                                                            AttributeFormat::eHalfFloat3, AttributeFormat::eHalfFloat4};
+        static const AttributeFormat::type kFloats[]     = {AttributeFormat::eFloat, AttributeFormat::eFloat2,
+                                                        AttributeFormat::eFloat3, AttributeFormat::eFloat4};
+        static const AttributeFormat::type kDoubles[]    = {AttributeFormat::eDouble, AttributeFormat::eDouble2,
+                                                         AttributeFormat::eDouble3, AttributeFormat::eDouble4};
+        static const AttributeFormat::type kShorts[]     = {AttributeFormat::eShort, AttributeFormat::eShort2,
+                                                        AttributeFormat::eShort3, AttributeFormat::eShort4};
+        static const AttributeFormat::type kInts[]       = {AttributeFormat::eInt, AttributeFormat::eInt2,
+                                                      AttributeFormat::eInt3, AttributeFormat::eInt4};
+        static const AttributeFormat::type kUInts[]      = {AttributeFormat::eUInt, AttributeFormat::eUInt2,
+                                                       AttributeFormat::eUInt3, AttributeFormat::eUInt4};
+
+        const uint32_t width = scalarId.word(2);
+        const AttributeFormat::type* formats = nullptr;
+        if (scalarId.opcode() == eOpTypeFloat)
+            formats = width == 16 ? kHalfFloats : (width == 32 ? kFloats : (width == 64 ? kDoubles : nullptr));
+        else if (scalarId.opcode() == eOpTypeInt && scalarId.wordCount > 3)
+        {
+            const bool isSigned = scalarId.word(3) != 0;
+            if (width == 16 && !isSigned)
+                formats = kShorts;
+            else if (width == 32)
+                formats = isSigned ? kInts : kUInts;
+        }
+        if (!formats)
+            return false;
+
+        result = formats[components - 1];
+        return true;
+    }
+}  // namespace
+
+ShaderReflection::ShaderReflection(const uint32_t* code, size_t wordCount, ShaderStage stage)
+    : m_stage(stage)
+{
+    Parser parser(code, wordCount);
+    if (!parser.parse())
+        return;
+
+    // entry points
+    std::map<uint32_t, size_t> entryIndices;
+    for (const uint32_t* words : parser.entryPoints())
+    {
+        const uint32_t wordCount = words[0] >> 16;
+
+        EntryPoint entry;
+        if (!stageFrom(words[1], entry.stage))
+            continue;
+        uint32_t stringWords;
+        entry.name = readString(words + 3, wordCount - 3, stringWords);
+
+        if (entry.stage == ShaderStage::eVertex)
+        {
+            // the interface lists the input variables
+            for (uint32_t i = 3 + stringWords; i < wordCount; ++i)
+            {
+                const Id& variable = parser.id(words[i]);
+                if (variable.opcode() != eOpVariable || variable.word(3) != eStorageInput || variable.location < 0 ||
+                    variable.builtIn >= 0)
+                    continue;
+
+                uint32_t  count;
+                uint32_t  type   = parser.elementType(parser.id(variable.word(1)).word(3), count);
+                const Id& typeId = parser.id(type);
+                // matrices take a location per column
+                uint32_t columns = 1;
+                if (typeId.opcode() == eOpTypeMatrix)
+                {
+                    columns = typeId.word(3);
+                    type    = typeId.word(2);
+                }
+
+                AttributeFormat format;
+                if (!attributeFormat(parser, type, format))
+                    continue;
+                // 64-bit three and four component vectors take two locations
+                const uint32_t size  = parser.typeSize(type);
+                const uint32_t slots = size > 16 ? 2 : 1;
+                for (uint32_t i = 0; i < std::max(count, 1u) * columns; ++i)
+                    entry.inputs.push_back({variable.location + i * slots, format, size});
+            }
+
+            // packs the inputs in location order, the offset temporarily holds the size
+            std::sort(entry.inputs.begin(), entry.inputs.end(),
+                      [](const VertexInput& lhs, const VertexInput& rhs) { return lhs.location < rhs.location; });
+            uint32_t offset = 0;
+            for (auto& input : entry.inputs)
+            {
+                const uint32_t size = input.offset;
+                input.offset        = offset;
+                offset += size;
+            }
+            entry.inputStride = offset;
+        }
+
+        entryIndices[words[2]] = m_entryPoints.size();
+        m_entryPoints.push_back(entry);
+    }
+
+    // workgroup sizes, the builtin constant overrides the execution modes
+    for (const uint32_t* words : parser.executionModes())
+    {
+        auto found = entryIndices.find(words[1]);
+        if (found == entryIndices.end())
+            continue;
+
+        const uint32_t wordCount = words[0] >> 16;
+        const uint32_t opcode    = words[0] & 0xffff;
+        EntryPoint&    entry     = m_entryPoints[found->second];
+        if (opcode == eOpExecutionMode && words[2] == kExecutionModeLocalSize && wordCount >= 6)
+        {
+            for (int i = 0; i < 3; ++i)
+                entry.localSize[i] = words[3 + i];
+        }
+        else if (opcode == eOpExecutionModeId && words[2] == kExecutionModeLocalSizeId && wordCount >= 6)
+        {
+            // the operands are ids of constants or specialization constants
+            for (int i = 0; i < 3; ++i)
+            {
+                entry.localSize[i]       = parser.constant(words[3 + i]);
+                entry.localSizeSpecId[i] = parser.id(words[3 + i]).specId;
+            }
+        }
+    }
+    for (const uint32_t index : parser.workgroupSizes())
+    {
+        const Id& composite = parser.id(index);
+        if (composite.wordCount < 6)
+            continue;
+
+        for (auto& entry : m_entryPoints)
+        {
+            if (entry.stage != ShaderStage::eCompute)
+                continue;
+            for (int i = 0; i < 3; ++i)
+            {
+                entry.localSize[i]       = parser.constant(composite.words[3 + i]);
+                entry.localSizeSpecId[i] = parser.id(composite.words[3 + i]).specId;
+            }
+        }
+    }
+
+    // descriptors and push constants
+    uint32_t pushEnd = 0;
+    for (const uint32_t index : parser.variables())
+    {
+        const Id&      variable     = parser.id(index);
+        const uint32_t storageClass = variable.word(3);
+        const Id&      pointer      = parser.id(variable.word(1));
+        if (pointer.opcode() != eOpTypePointer)
+            continue;
+
+        if (storageClass == eStoragePushConstant)
+        {
+            const Id& block = parser.id(pointer.word(3));
+            if (block.memberOffsets.empty())
+                continue;
+            m_pushOffset = *std::min_element(block.memberOffsets.begin(), block.memberOffsets.end());
+            pushEnd      = std::max(pushEnd, parser.typeSize(pointer.word(3)));
+            continue;
+        }
+        if (storageClass != eStorageUniformConstant && storageClass != eStorageUniform &&
+            storageClass != eStorageStorageBuffer)
+            continue;
+        if (variable.binding < 0 || variable.set >= kMaxDescriptorSets)
+            continue;
+
+        Binding binding;
+        binding.set     = variable.set < 0 ? 0 : variable.set;
+        binding.binding = variable.binding;
+        const uint32_t type = parser.elementType(pointer.word(3), binding.count);
+        if (!descriptorType(parser, storageClass, type, binding.type))
+            continue;
+        binding.name = variable.name.empty() ? parser.id(type).name : variable.name;
+        m_bindings.push_back(binding);
+    }
+    m_pushSize = pushEnd > m_pushOffset ? pushEnd - m_pushOffset : 0;
+
+    std::sort(m_bindings.begin(), m_bindings.end(), [](const Binding& lhs, const Binding& rhs) {
+        return lhs.set != rhs.set ? lhs.set < rhs.set : lhs.binding < rhs.binding;
+    });
+    m_valid = true;
+}
+
+const ShaderReflection::EntryPoint* ShaderReflection::entryPoint(const std::string& name) const
+{
+    auto found = std::find_if(m_entryPoints.begin(), m_entryPoints.end(),
+                              [&name](const EntryPoint& entry) { return entry.name == name; });
+    return found != m_entryPoints.end() ? &*found : nullptr;
+}
+
+std::vector<DescriptorLayoutParam> ShaderReflection::descriptorLayouts() const
+{
+    return descriptorLayouts({this});
+}
+
+VertexBinding ShaderReflection::vertexBinding(const std::string& entryPoint /*= "main"*/,
+                                              uint32_t           bindingIndex /*= 0*/) const
+{
+    const EntryPoint* entry = this->entryPoint(entryPoint);
+    assert(entry);
+
+    VertexBinding binding;
+    binding.bindingIndex = bindingIndex;
+    binding.offset       = 0;
+    binding.stride       = entry ? entry->inputStride : 0;
+    if (entry)
+        binding.attributes = entry->inputs;
+    return binding;
+}
+
+std::vector<DescriptorLayoutParam> ShaderReflection::descriptorLayouts(
+    const std::vector<const ShaderReflection*>& stages)
+{
+    std::vector<DescriptorLayoutParam> layouts;
+    for (const auto stage : stages)
+    {
+        assert(stage && stage->valid());
+        for (const auto& binding : stage->m_bindings)
+        {
+            if (layouts.size() <= binding.set)
+                layouts.resize(binding.set + 1);
+
+            auto& bindings = layouts[binding.set].bindings;
+            auto  found    = std::find_if(bindings.begin(), bindings.end(), [&binding](const DescriptorBinding& other) {
+                return other.index == binding.binding;
+            });
+            if (found != bindings.end())
+            {
+                assert(found->type == binding.type && found->count == binding.count);
+                found->stageFlags |= stage->m_stage.get();
+                continue;
+            }
+            bindings.emplace_back(binding.binding, stage->m_stage.get(), binding.type, binding.count);
+        }
+    }
+    return layouts;
+}
+
+std::vector<RenderPipeline::CreateParams::PushParams> ShaderReflection::pushConstants(
+    const std::vector<const ShaderReflection*>& stages)
+{
+    std::vector<RenderPipeline::CreateParams::PushParams> ranges;
+    for (const auto stage : stages)
+    {
+        assert(stage && stage->valid());
+        if (!stage->m_pushSize)
+            continue;
+
+        // stages sharing the same block share a range
+        auto found = std::find_if(ranges.begin(), ranges.end(), [stage](const auto& range) {
+            return range.offset == stage->m_pushOffset && range.size == stage->m_pushSize;
+        });
+        if (found != ranges.end())
+            found->stages = ShaderStage::fromUnsafe(found->stages.get() | stage->m_stage.get());
+        else
+            ranges.push_back(stage->stagePushConstants());
+    }
+    return ranges;
+}
+
+}  // namespace ri
@@ -8,6 +8,7 @@
 #include <ri/CommandBuffer.h>
 #include <ri/CommandPool.h>
 #include <ri/DeviceContext.h>
+#include <ri/Fence.h>
 #include <ri/RenderPass.h>
 #include <ri/RenderTarget.h>
 #include <ri/Texture.h>
@@ -425,7 +426,7 @@ uint32_t Surface::acquire(uint64_t timeout /*= std::numeric_limits<uint64_t>::ma
     return m_currentTargetIndex;
 }
 
-bool Surface::present(const ri::DeviceContext& device)
+bool Surface::present(const ri::DeviceContext& device, Fence* fence /*= nullptr*/)
 {
     assert(m_currentTargetIndex != 0xFFFF);
 
@@ -444,9 +445,16 @@ bool Surface::present(const ri::DeviceContext& device)
         const auto handle                 = detail::getVkHandle(m_swapchainCommandBuffers[m_currentTargetIndex].cast());
         submitInfo.pCommandBuffers        = &handle;
 
+        VkFence fenceHandle = VK_NULL_HANDLE;
+        if (fence)
+        {
+            fence->reset();
+            fenceHandle = detail::getVkHandle(*fence);
+        }
+
         const auto queueHandle = detail::getDeviceQueue(device, DeviceOperation::eGraphics);
         RI_CHECK_RESULT_MSG("error at queue submit for surface present") =
-            vkQueueSubmit(queueHandle, 1, &submitInfo, VK_NULL_HANDLE);
+            vkQueueSubmit(queueHandle, 1, &submitInfo, fenceHandle);
     }
 
     // submit presentation